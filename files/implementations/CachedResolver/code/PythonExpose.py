@@ -136,10 +136,31 @@ class ResolverContext:
                                                                     "elements", f"{entity_element}_{entity_version}.usd"))
         else:
             entity_type, entity_identifier = assetPath.split("/")
-            # Here you would add your custom "latest version" query.
-            resolved_asset_path = os.path.join(ENTITY_TYPE_TO_DIR_PATH[entity_type],
-                                                entity_identifier,
-                                                f"{entity_identifier}_v002.usd")
+            # Resolve the latest version via the (cached) C++ directory listings.
+            resolved_asset_path = context.ResolveLatestVersion(os.path.join(ENTITY_TYPE_TO_DIR_PATH[entity_type],
+                                                                            entity_identifier,
+                                                                            f"{entity_identifier}_v{{latest}}.usd"))
         # Cache result
         context.AddCachingPair(assetPath, resolved_asset_path)
-        return resolved_asset_path
\ No newline at end of file
+        return resolved_asset_path
+
+    @staticmethod
+    @log_function_args
+    def ResolveAndCacheBatch(context, assetPaths):
+        """Resolve and cache multiple asset paths in a single call.
+        This gets called instead of ResolveAndCache when the resolver batch queries
+        all context dependent identifiers of a layer (sublayers, references, payloads).
+        This can be enabled by setting the "AR_BATCH_RESOLVE_LAYER_DEPENDENCIES" env var to 1
+        or by calling Resolver.SetBatchResolveLayerDependenciesState(True).
+
+        The results are served from the cache, so make sure to add each result
+        via context.AddCachingPair(assetPath, resolvedAssetPath).
+        By default we just run ResolveAndCache for each asset path, override this
+        to run a single bulk query against your pipeline instead.
+        Args:
+            context (CachedResolverContext): The active context.
+            assetPaths (list[str]): The unresolved asset paths, that are not cached yet.
+        """
+        LOG.debug("::: ResolverContext.ResolveAndCacheBatch | {}".format(assetPaths))
+        for assetPath in assetPaths:
+            ResolverContext.ResolveAndCache(context, assetPath)
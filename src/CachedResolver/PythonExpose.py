@@ -30,6 +30,7 @@ class UnitTestHelper:
     create_relative_path_identifier_call_counter = 0
     context_initialize_call_counter = 0
     resolve_and_cache_call_counter = 0
+    resolve_and_cache_batch_call_counter = 0
     current_directory_path = ""
 
     @classmethod
@@ -37,6 +38,7 @@ class UnitTestHelper:
         cls.create_relative_path_identifier_call_counter = 0
         cls.context_initialize_call_counter = 0
         cls.resolve_and_cache_call_counter = 0
+        cls.resolve_and_cache_batch_call_counter = 0
         cls.current_directory_path = current_directory_path
 
 
@@ -132,3 +134,26 @@ class ResolverContext:
             resolved_asset_path = os.path.normpath(os.path.join(anchor_path, relative_path))
             context.AddCachingPair(assetPath, resolved_asset_path)
         return resolved_asset_path
+
+    @staticmethod
+    @log_function_args
+    def ResolveAndCacheBatch(context, assetPaths):
+        """Resolve and cache multiple asset paths in a single call.
+        This gets called instead of ResolveAndCache when the resolver batch queries
+        all context dependent identifiers of a layer (sublayers, references, payloads).
+        This can be enabled by setting the "AR_BATCH_RESOLVE_LAYER_DEPENDENCIES" env var to 1
+        or by calling Resolver.SetBatchResolveLayerDependenciesState(True).
+
+        The results are served from the cache, so make sure to add each result
+        via context.AddCachingPair(assetPath, resolvedAssetPath).
+        By default we just run ResolveAndCache for each asset path, override this
+        to run a single bulk query against your pipeline instead.
+        Args:
+            context (CachedResolverContext): The active context.
+            assetPaths (list[str]): The unresolved asset paths, that are not cached yet.
+        """
+        LOG.debug("::: ResolverContext.ResolveAndCacheBatch | {}".format(assetPaths))
+        """The code below is only needed to verify that UnitTests work."""
+        UnitTestHelper.resolve_and_cache_batch_call_counter += 1
+        for assetPath in assetPaths:
+            ResolverContext.ResolveAndCache(context, assetPath)
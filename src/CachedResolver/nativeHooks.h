@@ -0,0 +1,81 @@
+#ifndef AR_CACHEDRESOLVER_NATIVE_HOOKS_H
+#define AR_CACHEDRESOLVER_NATIVE_HOOKS_H
+
+/* Native Hooks (C ABI)
+This header is self-contained (no USD/C++ dependencies), so that native hook libraries
+can be compiled against it without linking to the resolver.
+A native hook library implements any of the exported functions below, it gets loaded
+by setting the AR_CACHEDRESOLVER_NATIVE_HOOKS env var to the library path.
+Each hook that the library doesn't export falls back to its PythonExpose.py counterpart.
+
+All hooks return a non-zero value on success and must be thread safe, as misses are
+resolved concurrently (there is no GIL). The resolver owns all strings, the char pointers
+passed into hooks are only valid for the duration of the call and results are returned
+via the host API setResult function.
+*/
+
+#define CACHEDRESOLVER_NATIVE_HOOKS_API_VERSION 1
+
+#if defined(_WIN32)
+#   define CACHEDRESOLVER_NATIVE_HOOKS_EXPORT __declspec(dllexport)
+#else
+#   define CACHEDRESOLVER_NATIVE_HOOKS_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CachedResolverNativeContext CachedResolverNativeContext;
+typedef struct CachedResolverNativeResolver CachedResolverNativeResolver;
+typedef struct CachedResolverNativeResult CachedResolverNativeResult;
+
+/* The functions the resolver provides to the hooks, these map 1:1 to the
+Python exposed resolver/resolver context methods of the same name.
+*/
+typedef struct CachedResolverNativeHostApi
+{
+    int apiVersion;
+    void (*setResult)(CachedResolverNativeResult* result, const char* str);
+    const char* (*getMappingFilePath)(const CachedResolverNativeContext* ctx);
+    void (*addMappingPair)(CachedResolverNativeContext* ctx, const char* sourceStr, const char* targetStr);
+    void (*removeMappingByKey)(CachedResolverNativeContext* ctx, const char* sourceStr);
+    void (*addPrefixMappingPair)(CachedResolverNativeContext* ctx, const char* sourcePrefixStr, const char* targetPrefixStr);
+    void (*addCachingPair)(CachedResolverNativeContext* ctx, const char* sourceStr, const char* targetStr);
+    void (*removeCachingByKey)(CachedResolverNativeContext* ctx, const char* sourceStr);
+    int (*resolveLatestVersion)(const CachedResolverNativeContext* ctx, const char* filePathPattern, CachedResolverNativeResult* result);
+    void (*addCachedRelativePathIdentifierPair)(CachedResolverNativeResolver* resolver, const char* sourceStr, const char* targetStr);
+} CachedResolverNativeHostApi;
+
+/* Exported by the hook library, libraries built against a different
+CACHEDRESOLVER_NATIVE_HOOKS_API_VERSION are rejected.
+*/
+typedef int (*CachedResolverNativeHooksGetApiVersionFn)(void);
+/* Counterpart of ResolverContext.Initialize */
+typedef int (*CachedResolverNativeHooksInitializeFn)(const CachedResolverNativeHostApi* api,
+                                                     CachedResolverNativeContext* ctx);
+/* Counterpart of ResolverContext.ResolveAndCache, the resolved path gets returned via api->setResult.
+As with the Python hook, the hook is responsible for adding the caching pair(s).
+*/
+typedef int (*CachedResolverNativeHooksResolveAndCacheFn)(const CachedResolverNativeHostApi* api,
+                                                          CachedResolverNativeContext* ctx,
+                                                          const char* assetPath,
+                                                          CachedResolverNativeResult* result);
+/* Counterpart of Resolver.CreateRelativePathIdentifier, the identifier gets returned via api->setResult. */
+typedef int (*CachedResolverNativeHooksCreateRelativePathIdentifierFn)(const CachedResolverNativeHostApi* api,
+                                                                       CachedResolverNativeResolver* resolver,
+                                                                       const char* anchoredAssetPath,
+                                                                       const char* assetPath,
+                                                                       const char* anchorAssetPath,
+                                                                       CachedResolverNativeResult* result);
+
+#define CACHEDRESOLVER_NATIVE_HOOKS_GET_API_VERSION_SYMBOL "CachedResolverNativeHooksGetApiVersion"
+#define CACHEDRESOLVER_NATIVE_HOOKS_INITIALIZE_SYMBOL "CachedResolverNativeHooksInitialize"
+#define CACHEDRESOLVER_NATIVE_HOOKS_RESOLVE_AND_CACHE_SYMBOL "CachedResolverNativeHooksResolveAndCache"
+#define CACHEDRESOLVER_NATIVE_HOOKS_CREATE_RELATIVE_PATH_IDENTIFIER_SYMBOL "CachedResolverNativeHooksCreateRelativePathIdentifier"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AR_CACHEDRESOLVER_NATIVE_HOOKS_H
@@ -3,9 +3,11 @@
 
 #include "resolver.h"
 #include "resolverContext.h"
+#include "resolverNativeHooks.h"
 
 #include "pxr/base/arch/systemInfo.h"
 #include "pxr/base/tf/fileUtils.h"
+#include "pxr/base/tf/getenv.h"
 #include "pxr/base/tf/pathUtils.h"
 #include "pxr/base/tf/pyInvoke.h"
 #include "pxr/base/tf/staticTokens.h"
@@ -15,21 +17,22 @@
 #include "pxr/usd/ar/filesystemAsset.h"
 #include "pxr/usd/ar/filesystemWritableAsset.h"
 #include "pxr/usd/ar/notice.h"
+#include "pxr/usd/ar/resolverContextBinder.h"
 
+#include "python_hook.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <mutex>
 #include <thread>
+#include <set>
 #include <string>
 #include <regex>
-
-/*
-Safety-wise we lock via a mutex when we re-rout the relative path lookup to a Python call.
-In theory we probably don't need this, as our Python call does this anyway.
-See the _CreateIdentifier method for more information.
-*/
-static std::mutex g_resolver_create_identifier_mutex;
+#include <vector>
 
 namespace python = AR_BOOST_NAMESPACE::python;
 
@@ -37,6 +40,8 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 AR_DEFINE_RESOLVER(CachedResolver, ArResolver);
 
+static const PythonHook g_resolver_create_relative_path_identifier_hook(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver.CreateRelativePathIdentifier");
+
 static bool
 _IsRelativePath(const std::string& path)
 {
@@ -82,45 +87,93 @@ _ResolveAnchored(
     if (!anchorPath.empty()) {
         resolvedPath = TfStringCatPaths(anchorPath, path);
     }
-    return TfPathExists(resolvedPath) ? ArResolvedPath(TfAbsPath(resolvedPath)) : ArResolvedPath();
+    CachedResolverStatistics::Add(ResolverStatistic::StatCallCount);
+    if (!TfPathExists(resolvedPath)) {
+        return ArResolvedPath();
+    }
+    ArResolvedPath absResolvedPath(TfAbsPath(resolvedPath));
+    // Warm up the page cache for the (likely) following _OpenAsset call.
+    ReadAheadPool::GetInstance().Prefetch(absResolvedPath.GetPathString());
+    return absResolvedPath;
 }
 
+static double
+_GetCurrentTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Scope id 0 is reserved for "no active cache scope".
+static std::atomic<uint64_t> g_resolver_scope_id_counter{0};
+
+CachedResolver::_ScopedCache::_ScopedCache() : scopeId(++g_resolver_scope_id_counter) {}
+
 CachedResolver::CachedResolver() {
+    ContextRegistry<CachedResolverContext>::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_MAX_ENTRIES), 128), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_STAT_INTERVAL), 1.0));
+    ReadAheadPool::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_THREADS), 0), 0)),
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_MAX_IN_FLIGHT), 64), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_READ_AHEAD_EXPIRATION), 300.0));
+    MappedAssetCache::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_ASSET_CACHE_SIZE), 0), 0)) * 1024 * 1024);
     this->SetExposeRelativePathIdentifierState(TfGetenvBool(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_EXPOSE_RELATIVE_PATH_IDENTIFIERS), false));
+    this->SetBatchResolveLayerDependenciesState(TfGetenvBool(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_BATCH_RESOLVE_LAYER_DEPENDENCIES), false));
+    const std::string revalidationPolicyStr = TfGetenv(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_REVALIDATION_POLICY), "ttl");
+    if (revalidationPolicyStr == "never") {
+        this->SetRevalidationPolicy(CachedResolverRevalidationPolicy::Never);
+    } else if (revalidationPolicyStr == "ttl") {
+        this->SetRevalidationPolicy(CachedResolverRevalidationPolicy::TimeToLive);
+    } else if (revalidationPolicyStr == "scope") {
+        this->SetRevalidationPolicy(CachedResolverRevalidationPolicy::CacheScope);
+    } else {
+        TF_WARN("Invalid revalidation policy '%s', expected 'never', 'ttl' or 'scope'. "
+                "Falling back to 'ttl'.", revalidationPolicyStr.c_str());
+    }
+    this->SetRevalidationTTL(TfGetenvDouble(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_REVALIDATION_TTL), 60.0));
 };
 
 CachedResolver::~CachedResolver() = default;
 
+std::map<std::string, double> CachedResolver::GetStatistics() const{
+    return CachedResolverStatistics::Get();
+}
+
+void CachedResolver::ResetStatistics(){
+    CachedResolverStatistics::Reset();
+}
+
+std::map<std::string, double> CachedResolver::GetReadAheadStatistics() const{
+    return ReadAheadPool::GetInstance().GetStatistics();
+}
+
+void CachedResolver::ResetReadAheadStatistics(){
+    ReadAheadPool::GetInstance().ResetStatistics();
+}
+
+std::map<std::string, double> CachedResolver::GetAssetCacheStatistics() const{
+    return MappedAssetCache::GetInstance().GetStatistics();
+}
+
+void CachedResolver::ClearAssetCache(){
+    MappedAssetCache::GetInstance().Clear();
+}
+
 void CachedResolver::AddCachedRelativePathIdentifierPair(const std::string& sourceStr, const std::string& targetStr){
-    auto cache_find = cachedRelativePathIdentifierPairs.find(sourceStr);
-    if(cache_find != cachedRelativePathIdentifierPairs.end()){
-        cache_find->second = targetStr;
-    }else{
-        cachedRelativePathIdentifierPairs.insert(std::pair<std::string, std::string>(sourceStr,targetStr));
-    }
+    cachedRelativePathIdentifierPairs.InsertOrAssign(sourceStr, targetStr);
 }
 
 
 void CachedResolver::RemoveCachedRelativePathIdentifierByKey(const std::string& sourceStr){
-    const auto &it = cachedRelativePathIdentifierPairs.find(sourceStr);
-    if (it != cachedRelativePathIdentifierPairs.end()){
-        cachedRelativePathIdentifierPairs.erase(it);
-    }
+    cachedRelativePathIdentifierPairs.Erase(sourceStr);
 }
 
 
 void CachedResolver::RemoveCachedRelativePathIdentifierByValue(const std::string& targetStr){
-    for (auto it = cachedRelativePathIdentifierPairs.cbegin(); it != cachedRelativePathIdentifierPairs.cend();)
-    {
-        if (it->second == targetStr)
-        {
-            cachedRelativePathIdentifierPairs.erase(it++);
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    cachedRelativePathIdentifierPairs.EraseIf([&targetStr](const std::string& key, const std::string& value){
+        return value == targetStr;
+    });
 }
 
 std::string
@@ -130,6 +183,7 @@ CachedResolver::_CreateIdentifier(
 {
     TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_CreateIdentifier('%s', '%s')\n",
                                           assetPath.c_str(), anchorAssetPath.GetPathString().c_str());
+    CachedResolverStatistics::Add(ResolverStatistic::CreateIdentifierCount);
 
     if (assetPath.empty()) {
         return assetPath;
@@ -139,37 +193,83 @@ CachedResolver::_CreateIdentifier(
         return TfNormPath(assetPath);
     }
 
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    std::string identifier;
+    if (currentCache && currentCache->FindIdentifier(assetPath, anchorAssetPath, &identifier)) {
+        CachedResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return identifier;
+    }
+    identifier = this->_CreateIdentifierNoCache(assetPath, anchorAssetPath);
+    if (currentCache) {
+        currentCache->AddIdentifier(assetPath, anchorAssetPath, identifier);
+    }
+    return identifier;
+}
+
+std::string
+CachedResolver::_CreateIdentifierNoCache(
+    const std::string& assetPath,
+    const ArResolvedPath& anchorAssetPath) const
+{
+    // Batch query all context dependent identifiers of the anchor layer in one go,
+    // instead of querying them one by one when they get resolved.
+    if (this->batchResolveLayerDependenciesState && _IsNotFilePath(assetPath)) {
+        const CachedResolverContext* ctx = this->_GetCurrentContextPtr();
+        this->_ResolveAndCacheLayerDependencies(ctx ? ctx : &_fallbackContext, anchorAssetPath);
+    }
+
     const std::string anchoredAssetPath = _AnchorRelativePath(anchorAssetPath, assetPath);
     // Re-direct to Python to allow optional re-routing of relative paths
     // through the resolver.
     if (this->exposeRelativePathIdentifierState) {
         if (_IsFileRelativePath(assetPath)) {
-            auto cache_find = this->cachedRelativePathIdentifierPairs.find(anchoredAssetPath);
-            if(cache_find != this->cachedRelativePathIdentifierPairs.end()){
-                return cache_find->second;
-            }else{
-                std::string pythonResult;
-                {
-                    /*
-                    We optionally re-route relative file paths to be pre-formatted in Python.
-                    This allows us to optionally override relative paths too and not only
-                    non file path identifiers.
-                    Please see the CachedResolverContext::ResolveAndCachePair method for
-                    risks (as this does the same hacky workaround)
-                    and the Python Resolver.CreateRelativePathIdentified method on how to use this. 
-                    */
-                    const std::lock_guard<std::mutex> lock(g_resolver_create_identifier_mutex);
-                    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                                     "Resolver.CreateRelativePathIdentifier",
-                                                     &pythonResult, AR_BOOST_NAMESPACE::ref(*this), anchoredAssetPath, assetPath, anchorAssetPath);
-                    if (!state) {
-                        std::cerr << "Failed to call Resolver.CreateRelativePathIdentifier in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
-                        std::cerr << "Please verify that the python code is valid!" << std::endl;
-                        pythonResult = TfNormPath(anchoredAssetPath);
-                    }
+            // Identifier templates of the mapping file handle the common cases natively.
+            const CachedResolverContext* ctx = this->_GetCurrentContextPtr();
+            std::string identifier;
+            if ((ctx ? ctx : &_fallbackContext)->FindIdentifierTemplateMatch(anchoredAssetPath, &identifier)){
+                CachedResolverStatistics::Add(ResolverStatistic::MappingHitCount);
+                return identifier;
+            }
+            if (this->cachedRelativePathIdentifierPairs.Find(anchoredAssetPath, &identifier)){
+                CachedResolverStatistics::Add(ResolverStatistic::CacheHitCount);
+                return identifier;
+            }
+            CachedResolverStatistics::Add(ResolverStatistic::CacheMissCount);
+            /*
+            We optionally re-route relative file paths to be pre-formatted in Python.
+            This allows us to optionally override relative paths too and not only
+            non file path identifiers.
+            Please see the CachedResolverContext::ResolveAndCachePair method for
+            risks (as this does the same hacky workaround)
+            and the Python Resolver.CreateRelativePathIdentified method on how to use this.
+            We don't lock here, the GIL already serializes the Python calls and the identifier
+            cache is safe to be populated concurrently. Concurrent misses of the same
+            anchored asset path can query Python more than once, which is harmless.
+            */
+            const CachedResolverNativeHooks* nativeHooks = CachedResolverNativeHooks::Get();
+            if (nativeHooks && nativeHooks->HasCreateRelativePathIdentifier()) {
+                std::string nativeResult;
+                CachedResolverStatistics::Add(ResolverStatistic::NativeCallCount);
+                const CachedResolverStatistics::Clock::time_point nativeStartTime = CachedResolverStatistics::Clock::now();
+                int state = nativeHooks->CreateRelativePathIdentifier(this, anchoredAssetPath, assetPath, anchorAssetPath.GetPathString(), &nativeResult);
+                CachedResolverStatistics::AddTime(ResolverStatistic::NativeTime, nativeStartTime);
+                if (!state) {
+                    std::cerr << "Failed to call the native Resolver.CreateRelativePathIdentifier hook for '" << anchoredAssetPath << "'." << std::endl;
+                    nativeResult = TfNormPath(anchoredAssetPath);
                 }
-                return pythonResult;
+                return nativeResult;
             }
+            std::string pythonResult;
+            CachedResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+            const CachedResolverStatistics::Clock::time_point pythonStartTime = CachedResolverStatistics::Clock::now();
+            int state = g_resolver_create_relative_path_identifier_hook.CallAndExtract(&pythonResult, AR_BOOST_NAMESPACE::ref(*this), anchoredAssetPath, assetPath, anchorAssetPath);
+            CachedResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
+            if (!state) {
+                std::cerr << "Failed to call Resolver.CreateRelativePathIdentifier in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
+                std::cerr << "Please verify that the python code is valid!" << std::endl;
+                pythonResult = TfNormPath(anchoredAssetPath);
+            }
+            return pythonResult;
         }
     }
     // Anchor non file path based identifiers and see if a file exists.
@@ -214,38 +314,59 @@ CachedResolver::_Resolve(
     if (SdfLayer::IsAnonymousLayerIdentifier(assetPath)){
         return ArResolvedPath(assetPath);
     }
+    CachedResolverStatistics::Add(ResolverStatistic::ResolveCount);
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    ArResolvedPath resolvedPath;
+    if (currentCache && currentCache->FindResolvedPath(assetPath, &resolvedPath)) {
+        CachedResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return resolvedPath;
+    }
+    resolvedPath = this->_ResolveNoCache(assetPath);
+    if (currentCache) {
+        currentCache->AddResolvedPath(assetPath, resolvedPath);
+    }
+    return resolvedPath;
+}
 
+ArResolvedPath
+CachedResolver::_ResolveNoCache(
+    const std::string& assetPath) const
+{
     if (this->_IsContextDependentPath(assetPath)) {
         const CachedResolverContext* contexts[2] = {this->_GetCurrentContextPtr(), &_fallbackContext};
         for (const CachedResolverContext* ctx : contexts) {
             if (ctx) {
                 // Search for mapping pairs
-                auto &mappingPairs = ctx->GetMappingPairs();
-                auto map_find = mappingPairs.find(assetPath);
-                if(map_find != mappingPairs.end()){
-                    ArResolvedPath resolvedPath = _ResolveAnchored(this->emptyString, map_find->second);
-                    return resolvedPath;
+                CachedResolverContextEntryPtr mappingEntry = ctx->FindMappingEntry(assetPath);
+                if(mappingEntry){
+                    CachedResolverStatistics::Add(ResolverStatistic::MappingHitCount);
                     // Assume that a map hit is always valid.
-                    // if (resolvedPath) {
-                    //     return resolvedPath;
-                    // }
+                    return this->_ResolveEntry(ctx, assetPath, mappingEntry, _EntryType::Mapping);
+                }
+                // Search for prefix mapping pairs, exact mapping pairs have priority.
+                CachedResolverContextEntryPtr prefixMappingEntry = ctx->FindPrefixMappingEntry(assetPath);
+                if(prefixMappingEntry){
+                    CachedResolverStatistics::Add(ResolverStatistic::MappingHitCount);
+                    return this->_ResolveEntry(ctx, assetPath, prefixMappingEntry, _EntryType::PrefixMapping);
                 }
                 // Search for cached pairs
-                auto &cachedPairs = ctx->GetCachingPairs();
-                auto cache_find = cachedPairs.find(assetPath);
-                if(cache_find != cachedPairs.end()){
-                    ArResolvedPath resolvedPath = _ResolveAnchored(this->emptyString, cache_find->second);
-                    return resolvedPath;
+                CachedResolverContextEntryPtr cachingEntry = ctx->FindCachingEntry(assetPath);
+                if(cachingEntry){
+                    CachedResolverStatistics::Add(ResolverStatistic::CacheHitCount);
                     // Assume that a cache hit is always valid.
-                    // if (resolvedPath) {
-                    //     return resolvedPath;
-                    // }
+                    return this->_ResolveEntry(ctx, assetPath, cachingEntry, _EntryType::Caching);
                 }
                 // Perform query if caches don't have a hit.
+                CachedResolverStatistics::Add(ResolverStatistic::CacheMissCount);
+                // Evaluate the resolve rules natively before falling back to Python.
+                CachedResolverContextEntryPtr ruleEntry = ctx->ResolveAndCachePairFromRules(assetPath);
+                if(ruleEntry){
+                    return this->_ResolveEntry(ctx, assetPath, ruleEntry, _EntryType::Caching);
+                }
                 TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_Resolve('%s') -> No cache hit, switching to Python query\n", assetPath.c_str());
                 /*
-                We perform the resource/thread lock in the context itself to 
-                allow for resolver multithreading with different contexts.
+                Concurrent misses are de-duplicated per context and asset path
+                in the context itself to allow for resolver multithreading.
                 See .ResolveAndCachePair for more information.
                 */
                 ArResolvedPath resolvedPath = _ResolveAnchored(this->emptyString, ctx->ResolveAndCachePair(assetPath));
@@ -301,25 +422,23 @@ CachedResolver::_CreateDefaultContextForAsset(
         TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Skipping on same stage\n", assetPath.c_str());
         return ArResolverContext(_fallbackContext);
     }
-    auto map_iter = _sharedContexts.find(resolvedPath);
-    if(map_iter != _sharedContexts.end()){
-        if (map_iter->second.timestamp.GetTime() == this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime())
-        {
-            TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage\n", assetPath.c_str());
-            return ArResolverContext(map_iter->second.ctx);
-        }else{
+    // Reuse the context of this mapping file across stages (or create it).
+    CachedResolverContext ctx = ContextRegistry<CachedResolverContext>::GetInstance().FindOrCreate(
+        resolvedPathStr,
+        [&](){
+            return this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime();
+        },
+        [&](){
+            TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
+            CachedResolverStatistics::Add(ResolverStatistic::ContextCreationCount);
+            return CachedResolverContext(resolvedPath);
+        },
+        [&](CachedResolverContext& staleCtx){
             TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage, reloading due to changed timestamp\n", assetPath.c_str());
-            map_iter->second.ctx.ClearAndReinitialize();
-            return ArResolverContext(map_iter->second.ctx);
-        }
-    }
-    // Create new context
-    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
-    struct CachedResolverContextRecord record;
-    record.timestamp = this->_GetModificationTimestamp(assetPath, resolvedPath);
-    record.ctx = CachedResolverContext(resolvedPath);
-    _sharedContexts.insert(std::pair<std::string, CachedResolverContextRecord>(resolvedPath, record));
-    return ArResolverContext(record.ctx);
+            // Only the changed mapping pairs get replaced, see _RefreshContext.
+            staleCtx.ReloadFromMappingFilePath();
+        });
+    return ArResolverContext(ctx);
 }
 
 bool
@@ -339,9 +458,53 @@ CachedResolver::_RefreshContext(
     if (!ctx) {
         return;
     }
+    // If the context was only incrementally reloaded, we only reload the affected
+    // layers instead of having all stages on the context re-resolve everything.
+    std::map<std::string, std::string> changedPairs;
+    if (ctx->TakeChangedPairs(&changedPairs) && this->_ReloadChangedLayers(*ctx, changedPairs)) {
+        return;
+    }
     ArNotice::ResolverChanged(*ctx).Send();
 }
 
+bool
+CachedResolver::_ReloadChangedLayers(
+    const CachedResolverContext& ctx,
+    const std::map<std::string, std::string>& changedPairs) const
+{
+    // Identifiers that didn't resolve via a pair before could have been resolved
+    // (or failed to resolve) by any stage on the context, so these need a full refresh.
+    std::map<std::string, std::string> previousResolvedPaths;
+    for (const auto& it : changedPairs) {
+        if (it.second.empty()) {
+            return false;
+        }
+        previousResolvedPaths.emplace(it.first, TfAbsPath(it.second));
+    }
+    // A layer is affected if it was opened via a changed identifier and is still pointing
+    // to the previous target, this skips layers of other contexts with the same identifier.
+    auto isAffectedLayer = [&previousResolvedPaths](const SdfLayerHandle& layer){
+        auto it = previousResolvedPaths.find(layer->GetIdentifier());
+        return it != previousResolvedPaths.end() && layer->GetResolvedPath().GetPathString() == it->second;
+    };
+    ArResolverContextBinder binder{ArResolverContext(ctx)};
+    std::set<std::string> reloadedIdentifiers;
+    for (const SdfLayerHandle& layer : SdfLayer::GetLoadedLayers()) {
+        if (!layer || !isAffectedLayer(layer)) {
+            continue;
+        }
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_RefreshContext() - Reloading layer '%s'\n", layer->GetIdentifier().c_str());
+        // Re-resolve the identifier and load the layer content from the new target.
+        layer->UpdateAssetInfo();
+        layer->Reload(true);
+        reloadedIdentifiers.insert(layer->GetIdentifier());
+    }
+    // Changed identifiers without a loaded layer (e.g. failed to load before or only resolved
+    // via the Ar API) can't be refreshed via a layer reload. As ArNotice::ResolverChanged can only
+    // be scoped by context, not by identifier, the stages then have to re-resolve everything.
+    return reloadedIdentifiers.size() == previousResolvedPaths.size();
+}
+
 ArTimestamp
 CachedResolver::_GetModificationTimestamp(
     const std::string& assetPath,
@@ -350,7 +513,18 @@ CachedResolver::_GetModificationTimestamp(
     TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg(
         "Resolver::GetModificationTimestamp('%s', '%s')\n",
         assetPath.c_str(), resolvedPath.GetPathString().c_str());
-    return ArFilesystemAsset::GetModificationTimestamp(resolvedPath);
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    ArTimestamp timestamp;
+    if (currentCache && currentCache->FindModificationTimestamp(resolvedPath, &timestamp)) {
+        CachedResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return timestamp;
+    }
+    CachedResolverStatistics::Add(ResolverStatistic::StatCallCount);
+    timestamp = ArFilesystemAsset::GetModificationTimestamp(resolvedPath);
+    if (currentCache) {
+        currentCache->AddModificationTimestamp(resolvedPath, timestamp);
+    }
+    return timestamp;
 }
 
 std::shared_ptr<ArAsset>
@@ -360,6 +534,11 @@ CachedResolver::_OpenAsset(
     TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg(
         "Resolver::OpenAsset('%s')\n",
         resolvedPath.GetPathString().c_str());
+    ReadAheadPool::GetInstance().NotifyOpen(resolvedPath.GetPathString());
+    // Share a single memory mapping per file across all stages, if the asset cache is enabled.
+    if (std::shared_ptr<ArAsset> asset = MappedAssetCache::GetInstance().Open(resolvedPath.GetPathString())) {
+        return asset;
+    }
     return ArFilesystemAsset::Open(resolvedPath);
 }
 
@@ -375,10 +554,106 @@ CachedResolver::_OpenAssetForWrite(
     return ArFilesystemWritableAsset::Create(resolvedPath, writeMode);
 }
 
+void
+CachedResolver::_BeginCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_BeginCacheScope()\n");
+    _threadCache.BeginCacheScope(cacheScopeData);
+}
+
+void
+CachedResolver::_EndCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_EndCacheScope()\n");
+    _threadCache.EndCacheScope(cacheScopeData);
+}
+
+ArResolvedPath
+CachedResolver::_ResolveEntry(
+    const CachedResolverContext* ctx,
+    const std::string& assetPath,
+    const CachedResolverContextEntryPtr& entry,
+    const _EntryType entryType) const
+{
+    // Entries store their validated resolved path, so that we can skip
+    // the file system lookup (and the absolute path conversion) on cache hits.
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    const uint64_t scopeId = currentCache ? currentCache->scopeId : 0;
+    const double currentTime = _GetCurrentTime();
+    if (entry->isValidated) {
+        switch (this->revalidationPolicy) {
+            case CachedResolverRevalidationPolicy::Never:
+                return entry->resolvedPath;
+            case CachedResolverRevalidationPolicy::TimeToLive:
+                if (currentTime - entry->validationTime < this->revalidationTTL) {
+                    return entry->resolvedPath;
+                }
+                break;
+            case CachedResolverRevalidationPolicy::CacheScope:
+                if (scopeId != 0 && entry->validationScopeId == scopeId) {
+                    return entry->resolvedPath;
+                }
+                break;
+        }
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_ResolveEntry('%s') - Validating '%s'\n",
+                                          assetPath.c_str(), entry->targetStr.c_str());
+    const ArResolvedPath resolvedPath = _ResolveAnchored(this->emptyString, entry->targetStr);
+    // Outside of cache scopes there is no point in storing scope based validations.
+    if (this->revalidationPolicy == CachedResolverRevalidationPolicy::CacheScope && scopeId == 0) {
+        return resolvedPath;
+    }
+    auto validatedEntry = std::make_shared<CachedResolverContextEntry>(*entry);
+    validatedEntry->isValidated = true;
+    validatedEntry->resolvedPath = resolvedPath;
+    validatedEntry->validationTime = currentTime;
+    validatedEntry->validationScopeId = scopeId;
+    switch (entryType) {
+        case _EntryType::Mapping:
+            ctx->UpdateMappingEntry(assetPath, entry, validatedEntry);
+            break;
+        case _EntryType::PrefixMapping:
+            ctx->UpdatePrefixMappingEntry(assetPath, entry, validatedEntry);
+            break;
+        case _EntryType::Caching:
+            ctx->UpdateCachingEntry(assetPath, entry, validatedEntry);
+            break;
+    }
+    return resolvedPath;
+}
+
 const CachedResolverContext* 
 CachedResolver::_GetCurrentContextPtr() const
 {
     return _GetCurrentContextObject<CachedResolverContext>();
 }
 
+void
+CachedResolver::_ResolveAndCacheLayerDependencies(
+    const CachedResolverContext* ctx,
+    const ArResolvedPath& layerPath) const
+{
+    // Only batch each layer once per context (until the caching pairs get cleared).
+    if (!ctx->MarkLayerAsBatched(layerPath.GetPathString())) {
+        return;
+    }
+    // We only inspect already loaded layers, the anchor layer is loaded
+    // as its identifiers are being anchored to it.
+    SdfLayerHandle layer = SdfLayer::Find(layerPath.GetPathString());
+    if (!layer) {
+        return;
+    }
+    std::vector<std::string> assetPaths;
+    for (const std::string& dependency : layer->GetCompositionAssetDependencies()) {
+        if (_IsNotFilePath(dependency) && !SdfLayer::IsAnonymousLayerIdentifier(dependency)) {
+            assetPaths.push_back(TfNormPath(dependency));
+        }
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER).Msg("Resolver::_ResolveAndCacheLayerDependencies('%s') - Batch querying %zu identifiers\n",
+                                          layerPath.GetPathString().c_str(), assetPaths.size());
+    ctx->ResolveAndCachePairs(assetPaths);
+}
+
 PXR_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
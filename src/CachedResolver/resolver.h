@@ -4,10 +4,18 @@
 #include "api.h"
 #include "debugCodes.h"
 #include "resolverContext.h"
+#include "resolverDirectoryListingCache.h"
+
+#include "concurrent_string_map.h"
+#include "context_registry.h"
+#include "mapped_asset_cache.h"
+#include "read_ahead_pool.h"
+#include "scoped_resolve_cache.h"
 
 #include "pxr/pxr.h"
 #include "pxr/base/tf/getenv.h"
 #include "pxr/usd/ar/resolver.h"
+#include "pxr/usd/ar/threadLocalScopedCache.h"
 
 #include <memory>
 #include <string>
@@ -15,14 +23,21 @@
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-struct CachedResolverContextRecord
+/* Revalidation Policy
+Mapping/prefix mapping/caching pair entries store their validated resolved path, this policy
+controls when a cache hit has to re-check that the target still exists:
+- Never: Only validate on the first hit, all consecutive hits don't access the file system.
+- TimeToLive: Re-validate if the last validation is older than the revalidation TTL (default).
+- CacheScope: Validations are valid for the lifetime of the active ArResolverScopedCache,
+              outside of cache scopes every hit is re-validated.
+*/
+enum class CachedResolverRevalidationPolicy
 {
-    ArTimestamp timestamp;
-    CachedResolverContext ctx;
+    Never,
+    TimeToLive,
+    CacheScope
 };
 
-static std::map<std::string, CachedResolverContextRecord> _sharedContexts;
-
 class CachedResolver final : public ArResolver
 {
 public:
@@ -41,6 +56,20 @@ public:
         }
     }
 
+    AR_CACHEDRESOLVER_API
+    bool GetBatchResolveLayerDependenciesState(){ return this->batchResolveLayerDependenciesState; }
+    AR_CACHEDRESOLVER_API
+    void SetBatchResolveLayerDependenciesState(const bool state){ this->batchResolveLayerDependenciesState = state; }
+
+    AR_CACHEDRESOLVER_API
+    CachedResolverRevalidationPolicy GetRevalidationPolicy(){ return this->revalidationPolicy; }
+    AR_CACHEDRESOLVER_API
+    void SetRevalidationPolicy(const CachedResolverRevalidationPolicy policy){ this->revalidationPolicy = policy; }
+    AR_CACHEDRESOLVER_API
+    double GetRevalidationTTL(){ return this->revalidationTTL; }
+    AR_CACHEDRESOLVER_API
+    void SetRevalidationTTL(const double seconds){ this->revalidationTTL = seconds; }
+
     AR_CACHEDRESOLVER_API
     void AddCachedRelativePathIdentifierPair(const std::string& sourceStr, const std::string& targetStr);
     AR_CACHEDRESOLVER_API
@@ -48,9 +77,27 @@ public:
     AR_CACHEDRESOLVER_API
     void RemoveCachedRelativePathIdentifierByValue(const std::string& targetStr);
     AR_CACHEDRESOLVER_API
-    const std::map<std::string, std::string>& GetCachedRelativePathIdentifierPairs() const { return cachedRelativePathIdentifierPairs; }
+    const std::map<std::string, std::string> GetCachedRelativePathIdentifierPairs() const { return cachedRelativePathIdentifierPairs.GetSortedPairs([](const std::string& value){ return value; }); }
+    AR_CACHEDRESOLVER_API
+    void ClearCachedRelativePathIdentifierPairs() { cachedRelativePathIdentifierPairs.Clear(); }
+
+    AR_CACHEDRESOLVER_API
+    void ClearDirectoryListingCache() { CachedResolverDirectoryListingCache::Get().Clear(); }
+
+    // These are defined in the resolver library, so that the Python bindings don't
+    // get their own copy of the (header only) process wide statistics and singletons.
+    AR_CACHEDRESOLVER_API
+    std::map<std::string, double> GetStatistics() const;
+    AR_CACHEDRESOLVER_API
+    void ResetStatistics();
+    AR_CACHEDRESOLVER_API
+    std::map<std::string, double> GetReadAheadStatistics() const;
+    AR_CACHEDRESOLVER_API
+    void ResetReadAheadStatistics();
     AR_CACHEDRESOLVER_API
-    void ClearCachedRelativePathIdentifierPairs() { cachedRelativePathIdentifierPairs.clear(); }
+    std::map<std::string, double> GetAssetCacheStatistics() const;
+    AR_CACHEDRESOLVER_API
+    void ClearAssetCache();
 protected:
     AR_CACHEDRESOLVER_API
     std::string _CreateIdentifier(
@@ -88,13 +135,55 @@ protected:
     std::shared_ptr<ArWritableAsset> _OpenAssetForWrite(
         const ArResolvedPath& resolvedPath,
         WriteMode writeMode) const final;
+    AR_CACHEDRESOLVER_API
+    void _BeginCacheScope(
+        VtValue* cacheScopeData) final;
+    AR_CACHEDRESOLVER_API
+    void _EndCacheScope(
+        VtValue* cacheScopeData) final;
     
 private:
+    // Besides the scope id (see CachedResolverRevalidationPolicy::CacheScope),
+    // scopes also cache the resolver call results.
+    struct _ScopedCache : public ScopedResolveCache
+    {
+        _ScopedCache();
+        const uint64_t scopeId;
+    };
+    using _ThreadLocalScopedCache = ArThreadLocalScopedCache<_ScopedCache>;
+    mutable _ThreadLocalScopedCache _threadCache;
+    std::string _CreateIdentifierNoCache(
+        const std::string& assetPath,
+        const ArResolvedPath& anchorAssetPath) const;
+    ArResolvedPath _ResolveNoCache(
+        const std::string& assetPath) const;
+    enum class _EntryType
+    {
+        Mapping,
+        PrefixMapping,
+        Caching
+    };
+    ArResolvedPath _ResolveEntry(
+        const CachedResolverContext* ctx,
+        const std::string& assetPath,
+        const CachedResolverContextEntryPtr& entry,
+        const _EntryType entryType) const;
+
     const CachedResolverContext* _GetCurrentContextPtr() const;
+    void _ResolveAndCacheLayerDependencies(
+        const CachedResolverContext* ctx,
+        const ArResolvedPath& layerPath) const;
+    bool _ReloadChangedLayers(
+        const CachedResolverContext& ctx,
+        const std::map<std::string, std::string>& changedPairs) const;
     CachedResolverContext _fallbackContext;
     const std::string emptyString{""};
     bool exposeRelativePathIdentifierState{false};
-    std::map<std::string, std::string> cachedRelativePathIdentifierPairs;
+    bool batchResolveLayerDependenciesState{false};
+    CachedResolverRevalidationPolicy revalidationPolicy{CachedResolverRevalidationPolicy::TimeToLive};
+    double revalidationTTL{60.0};
+    // This is read from multiple threads (via _CreateIdentifier), while Python populates it.
+    ConcurrentStringMap<std::string> cachedRelativePathIdentifierPairs;
 };
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -2,28 +2,39 @@
 #define DEFINE_STRING(string) CONVERT_STRING(string)
 
 #include "resolverContext.h"
+#include "resolverDirectoryListingCache.h"
+#include "resolverNativeHooks.h"
+#include "resolverSharedMemoryCache.h"
 #include "resolverTokens.h"
 
 #include "pxr/pxr.h"
+#include "pxr/base/arch/fileSystem.h"
 #include "pxr/base/tf/getenv.h"
 #include "pxr/base/tf/pathUtils.h"
 #include "pxr/base/tf/pyInvoke.h"
+#include "pxr/base/work/detachedTask.h"
+#include "pxr/base/work/loops.h"
 #include <pxr/usd/sdf/layer.h>
 
+#include "python_hook.h"
+
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
-/*
-Safety-wise we lock via a mutex when we don't have a cache hit.
-In theory we probably don't need this, as our Python call does this anyway.
-See the _Resolve method for more information.
-*/
-static std::mutex g_resolver_query_mutex;
-
 PXR_NAMESPACE_USING_DIRECTIVE
 
+// Mapping files below this pair count are loaded single threaded, as spinning up the tasks isn't worth it.
+static const size_t g_parallel_bulk_load_min_pair_count = 50000;
+
+static const PythonHook g_resolver_context_initialize_hook(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "ResolverContext.Initialize");
+static const PythonHook g_resolver_context_resolve_and_cache_hook(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "ResolverContext.ResolveAndCache");
+static const PythonHook g_resolver_context_resolve_and_cache_batch_hook(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "ResolverContext.ResolveAndCacheBatch");
+
 bool getStringEndswithString(const std::string &value, const std::string &compareValue)
 {
     if (compareValue.size() > value.size())
@@ -52,6 +63,7 @@ bool getStringEndswithStrings(const std::string &value, const std::vector<std::s
 CachedResolverContext::CachedResolverContext() {
     TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolverContext() - Creating new context\n");
     this->Initialize();
+    this->_AttachSharedMemoryCache();
 }
 
 CachedResolverContext::CachedResolverContext(const CachedResolverContext& ctx) = default;
@@ -61,8 +73,30 @@ CachedResolverContext::CachedResolverContext(const std::string& mappingFilePath)
     TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolverContext('%s') - Creating new context\n", mappingFilePath.c_str());
     // Init
     this->SetMappingFilePath(TfAbsPath(mappingFilePath));
+    std::string snapshotFilePath;
+    double mappingFileModificationTime = 0.0;
+    uint64_t mappingFileSize = 0;
+    const bool isSnapshotEnabled = this->_GetSnapshotFilePath(&snapshotFilePath, &mappingFileModificationTime, &mappingFileSize);
+    if (isSnapshotEnabled && this->_LoadSnapshot(snapshotFilePath, mappingFileModificationTime, mappingFileSize)){
+        this->_MarkAsLoaded(mappingFileModificationTime, mappingFileSize);
+        this->_AttachSharedMemoryCache();
+        return;
+    }
     this->_GetMappingPairsFromUsdFile(this->GetMappingFilePath());
     this->Initialize();
+    if (isSnapshotEnabled){
+        this->_WriteSnapshot(snapshotFilePath, mappingFileModificationTime, mappingFileSize);
+    }
+    this->_MarkAsLoaded(mappingFileModificationTime, mappingFileSize);
+    this->_AttachSharedMemoryCache();
+}
+
+CachedResolverContext::~CachedResolverContext()
+{
+    // The last copy persists the caching pairs that were added after the snapshot was written.
+    if (data.use_count() == 1){
+        this->FlushSnapshot();
+    }
 }
 
 bool
@@ -95,9 +129,21 @@ size_t hash_value(const CachedResolverContext& ctx)
 void CachedResolverContext::Initialize(){
     TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::Initialize()\n");
     
-    int state = TfPyInvoke(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                           "ResolverContext.Initialize",
-                           this);
+    const CachedResolverNativeHooks* nativeHooks = CachedResolverNativeHooks::Get();
+    if (nativeHooks && nativeHooks->HasInitialize()) {
+        CachedResolverStatistics::Add(ResolverStatistic::NativeCallCount);
+        const CachedResolverStatistics::Clock::time_point nativeStartTime = CachedResolverStatistics::Clock::now();
+        int state = nativeHooks->Initialize(this);
+        CachedResolverStatistics::AddTime(ResolverStatistic::NativeTime, nativeStartTime);
+        if (!state) {
+            std::cerr << "Failed to call the native ResolverContext.Initialize hook." << std::endl;
+        }
+        return;
+    }
+    CachedResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const CachedResolverStatistics::Clock::time_point pythonStartTime = CachedResolverStatistics::Clock::now();
+    int state = g_resolver_context_initialize_hook.Call(this);
+    CachedResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver.ResolveAndCache in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
@@ -106,38 +152,156 @@ void CachedResolverContext::Initialize(){
 
 void CachedResolverContext::ClearAndReinitialize(){
     TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ClearAndReinitialize()\n");
+    std::string snapshotFilePath;
+    double mappingFileModificationTime = 0.0;
+    uint64_t mappingFileSize = 0;
+    this->_GetSnapshotFilePath(&snapshotFilePath, &mappingFileModificationTime, &mappingFileSize);
     this->ClearMappingPairs();
     this->ClearCachingPairs();
     if (!this->GetMappingFilePath().empty()){
         this->RefreshFromMappingFilePath();
     }
     this->Initialize();
+    this->_MarkAsLoaded(mappingFileModificationTime, mappingFileSize);
+    // Any identifier can be affected now, so pending incremental changes aren't enough anymore.
+    std::lock_guard<std::mutex> lock(data->changedPairsMutex);
+    data->changedPairs.reset();
+    data->isFullReloadPending = true;
+}
+
+
+static bool
+_GetPairsFromLayerData(const VtDictionary& layerMetaData, const TfToken& key, VtStringArray* pairs)
+{
+    auto pairsDataPtr = layerMetaData.GetValueAtPath(key);
+    if (!pairsDataPtr || !pairsDataPtr->IsHolding<VtStringArray>()){
+        return false;
+    }
+    // This only shares the (copy on write) array data, the strings don't get copied.
+    *pairs = pairsDataPtr->UncheckedGet<VtStringArray>();
+    return pairs->size() % 2 == 0;
+}
+
+static SdfLayerRefPtr
+_OpenMappingLayer(const std::string& filePath)
+{
+    // Re-use the layer if it is already open (e.g. as the root layer of the stage),
+    // otherwise we only need the layer metadata and can skip parsing the prims.
+    if (SdfLayer::Find(filePath)){
+        return SdfLayer::FindOrOpen(filePath);
+    }
+    return SdfLayer::OpenAsAnonymous(filePath, true);
+}
+
+static CachedResolverContextEntryPtr
+_CreateEntry(const std::string& targetStr, uint64_t epoch)
+{
+    auto entry = std::make_shared<CachedResolverContextEntry>();
+    entry->targetStr = targetStr;
+    entry->epoch = epoch;
+    return entry;
+}
+
+static bool
+_IsStaleEntry(const CachedResolverContextEntryPtr& entry, uint64_t epoch)
+{
+    return entry && entry->epoch != epoch;
 }
 
+static void
+_ClearEntries(const std::shared_ptr<CachedResolverContextInternalData>& data,
+              ConcurrentStringMap<CachedResolverContextEntryPtr>& pairs,
+              std::atomic<uint64_t>& epoch)
+{
+    // Bumping the epoch invalidates all entries at once, without blocking concurrent readers.
+    // The stale entries (and tombstones, as the snapshot got dropped) are freed in the background.
+    const uint64_t currentEpoch = ++epoch;
+    std::weak_ptr<CachedResolverContextInternalData> weakData = data;
+    ConcurrentStringMap<CachedResolverContextEntryPtr>* pairsPtr = &pairs;
+    WorkRunDetachedTask([weakData, pairsPtr, currentEpoch](){
+        // The pairs are owned by the context data, so we only reclaim while it is alive.
+        std::shared_ptr<CachedResolverContextInternalData> data = weakData.lock();
+        if (!data){
+            return;
+        }
+        pairsPtr->EraseIf([currentEpoch](const std::string& key, const CachedResolverContextEntryPtr& entry){
+            return !entry || entry->epoch < currentEpoch;
+        });
+    });
+}
 
 bool CachedResolverContext::_GetMappingPairsFromUsdFile(const std::string& filePath)
 {
-    data->mappingPairs.clear();
+    this->ClearMappingPairs();
+    this->ClearPrefixMappingPairs();
+    this->ClearIdentifierTemplates();
+    this->ClearResolveRules();
     std::vector<std::string> usdFilePathExts{ ".usd", ".usdc", ".usda" };
     if (!getStringEndswithStrings(filePath, usdFilePathExts))
     {
         return false;
     }
-    auto layer = SdfLayer::FindOrOpen(TfAbsPath(filePath));
+    auto layer = _OpenMappingLayer(TfAbsPath(filePath));
     if (!layer){
         return false;
     }
     auto layerMetaData = layer->GetCustomLayerData();
-    auto mappingDataPtr = layerMetaData.GetValueAtPath(CachedResolverTokens->mappingPairs);
-    if (!mappingDataPtr){
-        return false;
+    pxr::VtStringArray prefixMappingDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, CachedResolverTokens->prefixMappingPairs, &prefixMappingDataArray)){
+        for (size_t i = 0; i < prefixMappingDataArray.size(); i+=2) {
+            this->AddPrefixMappingPair(prefixMappingDataArray[i], prefixMappingDataArray[i+1]);
+        }
+    }
+    pxr::VtStringArray identifierTemplateDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, CachedResolverTokens->identifierTemplates, &identifierTemplateDataArray)){
+        for (size_t i = 0; i < identifierTemplateDataArray.size(); i+=2) {
+            this->AddIdentifierTemplate(identifierTemplateDataArray[i], identifierTemplateDataArray[i+1]);
+        }
+    }
+    pxr::VtStringArray resolveRuleDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, CachedResolverTokens->resolveRules, &resolveRuleDataArray)){
+        for (size_t i = 0; i < resolveRuleDataArray.size(); i+=2) {
+            this->AddResolveRule(resolveRuleDataArray[i], resolveRuleDataArray[i+1]);
+        }
+    }
+    pxr::VtStringArray cachingDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, CachedResolverTokens->cachingPairs, &cachingDataArray)){
+        // These are pre-computed caching pairs (e.g. written by the cachedResolverWarm tool),
+        // which saves us the Python queries of the identifiers.
+        std::vector<std::pair<std::string, CachedResolverContextEntryPtr>> cachingPairs;
+        cachingPairs.reserve(cachingDataArray.size() / 2);
+        for (size_t i = 0; i < cachingDataArray.size(); i+=2) {
+            cachingPairs.emplace_back(cachingDataArray[i], _CreateEntry(cachingDataArray[i+1], data->cachingEpoch));
+        }
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::_GetMappingPairsFromUsdFile('%s') - Loading %zu caching pairs\n",
+                                                      filePath.c_str(), cachingPairs.size());
+        if (cachingPairs.size() < g_parallel_bulk_load_min_pair_count){
+            data->cachingPairs.BulkInsertOrAssign(std::move(cachingPairs));
+        }else{
+            data->cachingPairs.BulkInsertOrAssign(std::move(cachingPairs), [](size_t count, const auto& function){
+                WorkParallelForN(count, function);
+            });
+        }
     }
-    pxr::VtStringArray mappingDataArray = mappingDataPtr->Get<pxr::VtStringArray>();
-    if (mappingDataArray.size() % 2 != 0){
+    pxr::VtStringArray mappingDataArray;
+    if (!_GetPairsFromLayerData(layerMetaData, CachedResolverTokens->mappingPairs, &mappingDataArray)){
         return false;
     }
+    // Bulk load the mapping pairs instead of adding them one by one,
+    // this pre-sizes the shards and only takes each shard lock once.
+    std::vector<std::pair<std::string, CachedResolverContextEntryPtr>> mappingPairs;
+    mappingPairs.reserve(mappingDataArray.size() / 2);
     for (size_t i = 0; i < mappingDataArray.size(); i+=2) {
-        this->AddMappingPair(mappingDataArray[i], mappingDataArray[i+1]);
+        mappingPairs.emplace_back(mappingDataArray[i], _CreateEntry(mappingDataArray[i+1], data->mappingEpoch));
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::_GetMappingPairsFromUsdFile('%s') - Loading %zu mapping pairs\n",
+                                                  filePath.c_str(), mappingPairs.size());
+    if (mappingPairs.size() < g_parallel_bulk_load_min_pair_count){
+        data->mappingPairs.BulkInsertOrAssign(std::move(mappingPairs));
+    }else{
+        data->mappingPairs.BulkInsertOrAssign(std::move(mappingPairs), [](size_t count, const auto& function){
+            WorkParallelForN(count, function);
+        });
     }
     return true;
 }
@@ -146,89 +310,763 @@ void CachedResolverContext::RefreshFromMappingFilePath(){
     this->_GetMappingPairsFromUsdFile(this->GetMappingFilePath());
 }
 
-void CachedResolverContext::AddMappingPair(const std::string& sourceStr, const std::string& targetStr){
-    auto map_find = data->mappingPairs.find(sourceStr);
-    if(map_find != data->mappingPairs.end()){
-        map_find->second = targetStr;
+static std::vector<std::pair<std::string, std::string>>
+_GetPairVectorFromLayerData(const VtDictionary& layerMetaData, const TfToken& key)
+{
+    std::vector<std::pair<std::string, std::string>> pairs;
+    VtStringArray pairsDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, key, &pairsDataArray)){
+        pairs.reserve(pairsDataArray.size() / 2);
+        for (size_t i = 0; i < pairsDataArray.size(); i+=2) {
+            pairs.emplace_back(pairsDataArray[i], pairsDataArray[i+1]);
+        }
+    }
+    return pairs;
+}
+
+bool CachedResolverContext::ReloadFromMappingFilePath(){
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ReloadFromMappingFilePath()\n");
+    this->_DetachSharedMemoryCache();
+    std::string snapshotFilePath;
+    double mappingFileModificationTime = 0.0;
+    uint64_t mappingFileSize = 0;
+    this->_GetSnapshotFilePath(&snapshotFilePath, &mappingFileModificationTime, &mappingFileSize);
+    const std::string& filePath = this->GetMappingFilePath();
+    std::vector<std::string> usdFilePathExts{ ".usd", ".usdc", ".usda" };
+    SdfLayerRefPtr layer;
+    if (!filePath.empty() && getStringEndswithStrings(filePath, usdFilePathExts)){
+        layer = _OpenMappingLayer(filePath);
+    }
+    VtDictionary layerMetaData;
+    if (layer){
+        layerMetaData = layer->GetCustomLayerData();
+    }
+    // Prefix mapping pairs, identifier templates and resolve rules can affect any identifier,
+    // so if one of them changed, we have to fall back to a full reload. We don't track which
+    // caching pairs came from the file, so files with caching pairs always get fully reloaded.
+    const std::vector<std::pair<std::string, std::string>> prefixMappingPairVector = _GetPairVectorFromLayerData(layerMetaData, CachedResolverTokens->prefixMappingPairs);
+    if (!layer ||
+        layerMetaData.count(CachedResolverTokens->cachingPairs) ||
+        std::map<std::string, std::string>(prefixMappingPairVector.begin(), prefixMappingPairVector.end()) != this->GetPrefixMappingPairs() ||
+        _GetPairVectorFromLayerData(layerMetaData, CachedResolverTokens->identifierTemplates) != this->GetIdentifierTemplates() ||
+        _GetPairVectorFromLayerData(layerMetaData, CachedResolverTokens->resolveRules) != this->GetResolveRules()){
+        this->ClearAndReinitialize();
+        return false;
+    }
+    // Later duplicates win, the same as when bulk loading the mapping pairs.
+    std::map<std::string, std::string> fileMappingPairs;
+    for (auto& it : _GetPairVectorFromLayerData(layerMetaData, CachedResolverTokens->mappingPairs)){
+        fileMappingPairs[std::move(it.first)] = std::move(it.second);
+    }
+    // Only replace the pairs that changed, so that all other entries keep their validation state.
+    const std::map<std::string, std::string> previousMappingPairs = this->GetMappingPairs();
+    std::map<std::string, std::string> previousCachingTargets;
+    auto invalidate = [this, &previousMappingPairs, &previousCachingTargets](const std::string& sourceStr){
+        if (previousMappingPairs.find(sourceStr) == previousMappingPairs.end()){
+            CachedResolverContextEntryPtr cachingEntry = this->FindCachingEntry(sourceStr);
+            previousCachingTargets.emplace(sourceStr, cachingEntry ? cachingEntry->targetStr : std::string());
+        }
+        this->RemoveCachingByKey(sourceStr);
+    };
+    for (const auto& it : previousMappingPairs){
+        if (fileMappingPairs.find(it.first) == fileMappingPairs.end()){
+            this->RemoveMappingByKey(it.first);
+            invalidate(it.first);
+        }
+    }
+    for (const auto& it : fileMappingPairs){
+        auto previousIt = previousMappingPairs.find(it.first);
+        if (previousIt == previousMappingPairs.end() || previousIt->second != it.second){
+            this->AddMappingPair(it.first, it.second);
+            invalidate(it.first);
+        }
+    }
+    // Python can (re-)add pairs on initialization, the same as on a full reload.
+    this->Initialize();
+    this->_MarkAsLoaded(mappingFileModificationTime, mappingFileSize);
+    // Collect the changed pairs with the targets they pointed to before (empty if they weren't paired).
+    const std::map<std::string, std::string> mappingPairs = this->GetMappingPairs();
+    std::map<std::string, std::string> changedPairs;
+    for (const auto& it : previousMappingPairs){
+        auto currentIt = mappingPairs.find(it.first);
+        if (currentIt == mappingPairs.end() || currentIt->second != it.second){
+            changedPairs.emplace(it.first, it.second);
+        }
+    }
+    for (const auto& it : mappingPairs){
+        if (previousMappingPairs.find(it.first) == previousMappingPairs.end()){
+            auto previousCachingIt = previousCachingTargets.find(it.first);
+            changedPairs.emplace(it.first, previousCachingIt != previousCachingTargets.end() ? previousCachingIt->second : std::string());
+        }
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ReloadFromMappingFilePath() - %zu changed mapping pairs\n",
+                                                  changedPairs.size());
+    std::lock_guard<std::mutex> lock(data->changedPairsMutex);
+    if (!data->isFullReloadPending){
+        if (!data->changedPairs){
+            data->changedPairs.emplace();
+        }
+        // Keep the oldest target, as that is what the layers were loaded from.
+        data->changedPairs->insert(changedPairs.begin(), changedPairs.end());
+    }
+    return true;
+}
+
+bool CachedResolverContext::TakeChangedPairs(std::map<std::string, std::string>* changedPairs) const{
+    std::lock_guard<std::mutex> lock(data->changedPairsMutex);
+    const bool hasChangedPairs = !data->isFullReloadPending && data->changedPairs;
+    if (hasChangedPairs){
+        *changedPairs = std::move(*data->changedPairs);
+    }
+    data->changedPairs.reset();
+    data->isFullReloadPending = false;
+    return hasChangedPairs;
+}
+
+static CachedResolverContextEntryPtr
+_FindEntry(ConcurrentStringMap<CachedResolverContextEntryPtr>& pairs,
+           uint64_t epoch,
+           const CachedResolverContextSnapshotPtr& snapshotPtr,
+           CachedResolverContextSnapshot::Section section,
+           const std::string& sourceStr)
+{
+    CachedResolverContextEntryPtr entry;
+    if (pairs.Find(sourceStr, &entry)){
+        // This is nullptr for tombstones of removed snapshot pairs.
+        // Stale entries are from before the last clear, which also dropped the snapshot.
+        return _IsStaleEntry(entry, epoch) ? nullptr : entry;
+    }
+    const CachedResolverContextSnapshotPtr snapshot = std::atomic_load(&snapshotPtr);
+    std::string_view snapshotTargetStr;
+    if (!snapshot || !snapshot->Find(section, sourceStr, &snapshotTargetStr)){
+        return nullptr;
+    }
+    // Promote the snapshot pair on first hit, so that its validation state can be cached.
+    return pairs.FindOrInsert(sourceStr, [&snapshotTargetStr, epoch](){
+        return _CreateEntry(std::string(snapshotTargetStr), epoch);
+    });
+}
+
+static void
+_RemoveEntry(ConcurrentStringMap<CachedResolverContextEntryPtr>& pairs,
+             const CachedResolverContextSnapshotPtr& snapshotPtr,
+             CachedResolverContextSnapshot::Section section,
+             const std::string& sourceStr)
+{
+    const CachedResolverContextSnapshotPtr snapshot = std::atomic_load(&snapshotPtr);
+    std::string_view snapshotTargetStr;
+    if (snapshot && snapshot->Find(section, sourceStr, &snapshotTargetStr)){
+        pairs.InsertOrAssign(sourceStr, nullptr);
     }else{
-        data->mappingPairs.insert(std::pair<std::string, std::string>(sourceStr,targetStr));
+        pairs.Erase(sourceStr);
     }
 }
 
-void CachedResolverContext::RemoveMappingByKey(const std::string& sourceStr){
-    const auto &it = data->mappingPairs.find(sourceStr);
-    if (it != data->mappingPairs.end()){
-        data->mappingPairs.erase(it);
+static void
+_RemoveEntriesByValue(ConcurrentStringMap<CachedResolverContextEntryPtr>& pairs,
+                      uint64_t epoch,
+                      const CachedResolverContextSnapshotPtr& snapshotPtr,
+                      CachedResolverContextSnapshot::Section section,
+                      const std::string& targetStr)
+{
+    std::vector<std::string> sourceStrs;
+    pairs.ForEach([epoch, &targetStr, &sourceStrs](const std::string& key, const CachedResolverContextEntryPtr& entry){
+        if (entry && entry->epoch == epoch && entry->targetStr == targetStr){
+            sourceStrs.push_back(key);
+        }
+    });
+    const CachedResolverContextSnapshotPtr snapshot = std::atomic_load(&snapshotPtr);
+    if (snapshot){
+        snapshot->ForEach(section, [&targetStr, &sourceStrs](std::string_view key, std::string_view value){
+            if (value == targetStr){
+                sourceStrs.emplace_back(key);
+            }
+        });
+    }
+    for (const std::string& sourceStr : sourceStrs){
+        _RemoveEntry(pairs, snapshotPtr, section, sourceStr);
     }
 }
 
-void CachedResolverContext::RemoveMappingByValue(const std::string& targetStr){
-    for (auto it = data->mappingPairs.cbegin(); it != data->mappingPairs.cend();)
-    {
-        if (it->second == targetStr)
-        {
-            data->mappingPairs.erase(it++);
+static std::map<std::string, std::string>
+_GetSortedPairs(const ConcurrentStringMap<CachedResolverContextEntryPtr>& pairs,
+                uint64_t epoch,
+                const CachedResolverContextSnapshotPtr& snapshotPtr,
+                CachedResolverContextSnapshot::Section section)
+{
+    std::map<std::string, std::string> sortedPairs;
+    const CachedResolverContextSnapshotPtr snapshot = std::atomic_load(&snapshotPtr);
+    if (snapshot){
+        snapshot->ForEach(section, [&sortedPairs](std::string_view key, std::string_view value){
+            sortedPairs.emplace(std::string(key), std::string(value));
+        });
+    }
+    pairs.ForEach([epoch, &sortedPairs](const std::string& key, const CachedResolverContextEntryPtr& entry){
+        if (_IsStaleEntry(entry, epoch)){
+            return;
         }
-        else
-        {
-            ++it;
+        if (entry){
+            sortedPairs[key] = entry->targetStr;
+        }else{
+            sortedPairs.erase(key);
         }
+    });
+    return sortedPairs;
+}
+
+void CachedResolverContext::AddMappingPair(const std::string& sourceStr, const std::string& targetStr){
+    data->mappingPairs.InsertOrAssign(sourceStr, _CreateEntry(targetStr, data->mappingEpoch));
+}
+
+void CachedResolverContext::RemoveMappingByKey(const std::string& sourceStr){
+    data->isEdited = true;
+    _RemoveEntry(data->mappingPairs, data->mappingSnapshot, CachedResolverContextSnapshot::MappingPairs, sourceStr);
+}
+
+void CachedResolverContext::RemoveMappingByValue(const std::string& targetStr){
+    data->isEdited = true;
+    _RemoveEntriesByValue(data->mappingPairs, data->mappingEpoch, data->mappingSnapshot, CachedResolverContextSnapshot::MappingPairs, targetStr);
+}
+
+const std::map<std::string, std::string> CachedResolverContext::GetMappingPairs() const{
+    return _GetSortedPairs(data->mappingPairs, data->mappingEpoch, data->mappingSnapshot, CachedResolverContextSnapshot::MappingPairs);
+}
+
+CachedResolverContextEntryPtr CachedResolverContext::FindMappingEntry(const std::string& sourceStr) const{
+    return _FindEntry(data->mappingPairs, data->mappingEpoch, data->mappingSnapshot, CachedResolverContextSnapshot::MappingPairs, sourceStr);
+}
+
+void CachedResolverContext::UpdateMappingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const{
+    // If the pair got re-assigned in the meantime, we keep the newer entry.
+    data->mappingPairs.CompareAndAssign(sourceStr, entry, validatedEntry);
+}
+
+void CachedResolverContext::ClearMappingPairs(){
+    data->isEdited = true;
+    std::atomic_store(&data->mappingSnapshot, CachedResolverContextSnapshotPtr());
+    _ClearEntries(data, data->mappingPairs, data->mappingEpoch);
+}
+
+void CachedResolverContext::AddPrefixMappingPair(const std::string& sourcePrefixStr, const std::string& targetPrefixStr){
+    if (sourcePrefixStr.empty()){
+        TF_WARN("Skipping prefix mapping pair with an empty source prefix to '%s'", targetPrefixStr.c_str());
+        return;
+    }
+    {
+        const std::unique_lock<std::shared_mutex> lock(data->prefixMappingPairsMutex);
+        data->prefixMappingPairs.InsertOrAssign(sourcePrefixStr, targetPrefixStr);
+        data->prefixMappingPairCount = data->prefixMappingPairs.Size();
     }
+    _ClearEntries(data, data->prefixMappingEntries, data->prefixMappingEpoch);
 }
 
-void CachedResolverContext::AddCachingPair(const std::string& sourceStr, const std::string& targetStr){
-    auto cache_find = data->cachingPairs.find(sourceStr);
-    if(cache_find != data->cachingPairs.end()){
-        cache_find->second = targetStr;
-    }else{
-        data->cachingPairs.insert(std::pair<std::string, std::string>(sourceStr,targetStr));
+void CachedResolverContext::RemovePrefixMappingByKey(const std::string& sourcePrefixStr){
+    data->isEdited = true;
+    {
+        const std::unique_lock<std::shared_mutex> lock(data->prefixMappingPairsMutex);
+        data->prefixMappingPairs.Erase(sourcePrefixStr);
+        data->prefixMappingPairCount = data->prefixMappingPairs.Size();
     }
+    _ClearEntries(data, data->prefixMappingEntries, data->prefixMappingEpoch);
 }
 
-void CachedResolverContext::RemoveCachingByKey(const std::string& sourceStr){
-    const auto &it = data->cachingPairs.find(sourceStr);
-    if (it != data->cachingPairs.end()){
-        data->cachingPairs.erase(it);
+const std::map<std::string, std::string> CachedResolverContext::GetPrefixMappingPairs() const{
+    std::map<std::string, std::string> prefixMappingPairs;
+    const std::shared_lock<std::shared_mutex> lock(data->prefixMappingPairsMutex);
+    data->prefixMappingPairs.ForEach([&prefixMappingPairs](const std::string& key, const std::string& value){
+        prefixMappingPairs.emplace(key, value);
+    });
+    return prefixMappingPairs;
+}
+
+void CachedResolverContext::ClearPrefixMappingPairs(){
+    data->isEdited = true;
+    {
+        const std::unique_lock<std::shared_mutex> lock(data->prefixMappingPairsMutex);
+        data->prefixMappingPairs.Clear();
+        data->prefixMappingPairCount = 0;
+    }
+    _ClearEntries(data, data->prefixMappingEntries, data->prefixMappingEpoch);
+}
+
+bool CachedResolverContext::FindPrefixMapping(const std::string& sourceStr, std::string* targetStr) const{
+    if (data->prefixMappingPairCount == 0){
+        return false;
+    }
+    const std::shared_lock<std::shared_mutex> lock(data->prefixMappingPairsMutex);
+    const std::string* targetPrefixStr;
+    size_t sourcePrefixSize;
+    if (!data->prefixMappingPairs.FindLongestPrefix(sourceStr, &targetPrefixStr, &sourcePrefixSize)){
+        return false;
     }
+    *targetStr = *targetPrefixStr + sourceStr.substr(sourcePrefixSize);
+    return true;
+}
+
+CachedResolverContextEntryPtr CachedResolverContext::FindPrefixMappingEntry(const std::string& sourceStr) const{
+    if (data->prefixMappingPairCount == 0){
+        return nullptr;
+    }
+    // The epoch is read before the lookup, so that entries of concurrently changed prefixes end up stale.
+    const uint64_t epoch = data->prefixMappingEpoch;
+    CachedResolverContextEntryPtr entry;
+    if (data->prefixMappingEntries.Find(sourceStr, &entry) && !_IsStaleEntry(entry, epoch)){
+        return entry;
+    }
+    std::string targetStr;
+    if (!this->FindPrefixMapping(sourceStr, &targetStr)){
+        return nullptr;
+    }
+    entry = _CreateEntry(targetStr, epoch);
+    data->prefixMappingEntries.InsertOrAssign(sourceStr, entry);
+    return entry;
+}
+
+void CachedResolverContext::UpdatePrefixMappingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const{
+    data->prefixMappingEntries.CompareAndAssign(sourceStr, entry, validatedEntry);
+}
+
+bool CachedResolverContext::AddIdentifierTemplate(const std::string& regexExpressionStr, const std::string& formatStr){
+    std::string errorMsg;
+    if (!data->identifierTemplates.Add(regexExpressionStr, formatStr, &errorMsg)){
+        TF_WARN("Skipping invalid identifier template regex '%s': %s", regexExpressionStr.c_str(), errorMsg.c_str());
+        return false;
+    }
+    return true;
+}
+
+const std::vector<std::pair<std::string, std::string>> CachedResolverContext::GetIdentifierTemplates() const{
+    return data->identifierTemplates.Get();
+}
+
+void CachedResolverContext::ClearIdentifierTemplates(){
+    data->isEdited = true;
+    data->identifierTemplates.Clear();
+}
+
+bool CachedResolverContext::FindIdentifierTemplateMatch(const std::string& anchoredAssetPath, std::string* identifier) const{
+    return data->identifierTemplates.Match(anchoredAssetPath, identifier);
+}
+
+bool CachedResolverContext::AddResolveRule(const std::string& regexExpressionStr, const std::string& formatStr){
+    std::string errorMsg;
+    if (!data->resolveRules.Add(regexExpressionStr, formatStr, &errorMsg)){
+        TF_WARN("Skipping invalid resolve rule regex '%s': %s", regexExpressionStr.c_str(), errorMsg.c_str());
+        return false;
+    }
+    return true;
+}
+
+const std::vector<std::pair<std::string, std::string>> CachedResolverContext::GetResolveRules() const{
+    return data->resolveRules.Get();
+}
+
+void CachedResolverContext::ClearResolveRules(){
+    data->isEdited = true;
+    data->resolveRules.Clear();
+}
+
+CachedResolverContextEntryPtr CachedResolverContext::ResolveAndCachePairFromRules(const std::string& assetPath) const{
+    std::string targetStr;
+    if (!data->resolveRules.Match(assetPath, &targetStr)){
+        return nullptr;
+    }
+    if (targetStr.find("{latest}") != std::string::npos){
+        // If no version exists, we still cache the (empty) result, like we do for Python queries.
+        targetStr = this->ResolveLatestVersion(targetStr);
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolveAndCachePairFromRules('%s') -> '%s'\n",
+                                                  assetPath.c_str(), targetStr.c_str());
+    // Store the result like a Python query result, so that the rules only get evaluated once.
+    CachedResolverContextEntryPtr entry = _CreateEntry(targetStr, data->cachingEpoch);
+    data->cachingPairs.InsertOrAssign(assetPath, entry);
+    data->hasUnsavedCachingPairs = true;
+    return entry;
+}
+
+const std::string CachedResolverContext::ResolveLatestVersion(const std::string& filePathPattern) const{
+    return CachedResolverDirectoryListingCache::Get().FindLatestVersion(filePathPattern);
+}
+
+void CachedResolverContext::AddCachingPair(const std::string& sourceStr, const std::string& targetStr){
+    data->cachingPairs.InsertOrAssign(sourceStr, _CreateEntry(targetStr, data->cachingEpoch));
+    data->hasUnsavedCachingPairs = true;
+}
+
+void CachedResolverContext::RemoveCachingByKey(const std::string& sourceStr){
+    this->_DetachSharedMemoryCache();
+    _RemoveEntry(data->cachingPairs, data->cachingSnapshot, CachedResolverContextSnapshot::CachingPairs, sourceStr);
 }
 
 void CachedResolverContext::RemoveCachingByValue(const std::string& targetStr){
-    for (auto it = data->cachingPairs.cbegin(); it != data->cachingPairs.cend();)
-    {
-        if (it->second == targetStr)
-        {
-            data->cachingPairs.erase(it++);
-        }
-        else
-        {
-            ++it;
+    this->_DetachSharedMemoryCache();
+    _RemoveEntriesByValue(data->cachingPairs, data->cachingEpoch, data->cachingSnapshot, CachedResolverContextSnapshot::CachingPairs, targetStr);
+}
+
+const std::map<std::string, std::string> CachedResolverContext::GetCachingPairs() const{
+    return _GetSortedPairs(data->cachingPairs, data->cachingEpoch, data->cachingSnapshot, CachedResolverContextSnapshot::CachingPairs);
+}
+
+CachedResolverContextEntryPtr CachedResolverContext::FindCachingEntry(const std::string& sourceStr) const{
+    return _FindEntry(data->cachingPairs, data->cachingEpoch, data->cachingSnapshot, CachedResolverContextSnapshot::CachingPairs, sourceStr);
+}
+
+void CachedResolverContext::UpdateCachingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const{
+    // If the pair got re-assigned in the meantime, we keep the newer entry.
+    data->cachingPairs.CompareAndAssign(sourceStr, entry, validatedEntry);
+}
+
+void CachedResolverContext::ClearCachingPairs(){
+    this->_DetachSharedMemoryCache();
+    std::atomic_store(&data->cachingSnapshot, CachedResolverContextSnapshotPtr());
+    _ClearEntries(data, data->cachingPairs, data->cachingEpoch);
+    data->batchedLayers.Clear();
+}
+
+void CachedResolverContext::_AttachSharedMemoryCache(){
+    if (!CachedResolverSharedMemoryCache::Get()){
+        return;
+    }
+    // Contexts of a changed (e.g. repinned) mapping file get a new key, so they don't get served the previous results.
+    const std::string& mappingFilePath = this->GetMappingFilePath();
+    std::string sharedMemoryCacheKey = mappingFilePath;
+    double mappingFileModificationTime = 0.0;
+    if (!mappingFilePath.empty() && ArchGetModificationTime(mappingFilePath.c_str(), &mappingFileModificationTime)){
+        sharedMemoryCacheKey += "|" + std::to_string(mappingFileModificationTime);
+        sharedMemoryCacheKey += "|" + std::to_string(ArchGetFileLength(mappingFilePath.c_str()));
+    }
+    std::atomic_store(&data->sharedMemoryCacheKey, std::make_shared<const std::string>(std::move(sharedMemoryCacheKey)));
+}
+
+void CachedResolverContext::_DetachSharedMemoryCache(){
+    std::atomic_store(&data->sharedMemoryCacheKey, std::shared_ptr<const std::string>());
+}
+
+bool CachedResolverContext::_GetSnapshotFilePath(std::string* snapshotFilePath, double* mappingFileModificationTime, uint64_t* mappingFileSize) const{
+    const std::string snapshotDirPath = TfGetenv(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_SNAPSHOT_DIR));
+    const std::string& mappingFilePath = this->GetMappingFilePath();
+    if (snapshotDirPath.empty() || mappingFilePath.empty()){
+        return false;
+    }
+    if (!ArchGetModificationTime(mappingFilePath.c_str(), mappingFileModificationTime)){
+        return false;
+    }
+    const int64_t mappingFileLength = ArchGetFileLength(mappingFilePath.c_str());
+    if (mappingFileLength < 0){
+        return false;
+    }
+    *mappingFileSize = static_cast<uint64_t>(mappingFileLength);
+    *snapshotFilePath = CachedResolverContextSnapshot::GetSnapshotFilePath(snapshotDirPath, mappingFilePath);
+    return true;
+}
+
+bool CachedResolverContext::_LoadSnapshot(const std::string& snapshotFilePath, double mappingFileModificationTime, uint64_t mappingFileSize){
+    CachedResolverContextSnapshotPtr snapshot = CachedResolverContextSnapshot::Open(snapshotFilePath,
+                                                                                    this->GetMappingFilePath(),
+                                                                                    mappingFileModificationTime,
+                                                                                    mappingFileSize,
+                                                                                    TfGetenvBool(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_SNAPSHOT_VERIFY), false));
+    if (!snapshot){
+        return false;
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::_LoadSnapshot('%s') - Loaded snapshot\n", snapshotFilePath.c_str());
+    data->mappingPairs.Clear();
+    data->cachingPairs.Clear();
+    std::atomic_store(&data->mappingSnapshot, snapshot);
+    std::atomic_store(&data->cachingSnapshot, snapshot);
+    // Prefix mapping pairs are few, so we don't serve them from the mapping.
+    this->ClearPrefixMappingPairs();
+    snapshot->ForEach(CachedResolverContextSnapshot::PrefixMappingPairs, [this](std::string_view key, std::string_view value){
+        this->AddPrefixMappingPair(std::string(key), std::string(value));
+    });
+    this->ClearIdentifierTemplates();
+    snapshot->ForEach(CachedResolverContextSnapshot::IdentifierTemplates, [this](std::string_view key, std::string_view value){
+        this->AddIdentifierTemplate(std::string(key), std::string(value));
+    });
+    this->ClearResolveRules();
+    snapshot->ForEach(CachedResolverContextSnapshot::ResolveRules, [this](std::string_view key, std::string_view value){
+        this->AddResolveRule(std::string(key), std::string(value));
+    });
+    return true;
+}
+
+bool CachedResolverContext::_WriteSnapshot(const std::string& snapshotFilePath, double mappingFileModificationTime, uint64_t mappingFileSize) const{
+    // Caching pairs added while writing are flushed with the next write.
+    data->hasUnsavedCachingPairs = false;
+    if (!CachedResolverContextSnapshot::Write(snapshotFilePath,
+                                              this->GetMappingFilePath(),
+                                              mappingFileModificationTime,
+                                              mappingFileSize,
+                                              this->GetMappingPairs(),
+                                              this->GetCachingPairs(),
+                                              this->GetPrefixMappingPairs(),
+                                              this->GetIdentifierTemplates(),
+                                              this->GetResolveRules())){
+        data->hasUnsavedCachingPairs = true;
+        std::cerr << "Failed to write resolver context snapshot to " << snapshotFilePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CachedResolverContext::SaveSnapshot() const{
+    std::string snapshotFilePath;
+    double mappingFileModificationTime;
+    uint64_t mappingFileSize;
+    if (!this->_GetSnapshotFilePath(&snapshotFilePath, &mappingFileModificationTime, &mappingFileSize)){
+        return false;
+    }
+    return this->_WriteSnapshot(snapshotFilePath, mappingFileModificationTime, mappingFileSize);
+}
+
+bool CachedResolverContext::FlushSnapshot() const{
+    if (data->isEdited || !data->hasUnsavedCachingPairs){
+        return false;
+    }
+    std::string snapshotFilePath;
+    double mappingFileModificationTime;
+    uint64_t mappingFileSize;
+    if (!this->_GetSnapshotFilePath(&snapshotFilePath, &mappingFileModificationTime, &mappingFileSize)){
+        return false;
+    }
+    // Pairs that were resolved against a previous version of the mapping file must not end up in the snapshot of the current one.
+    if (mappingFileModificationTime != data->loadedMappingFileModificationTime || mappingFileSize != data->loadedMappingFileSize){
+        return false;
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::FlushSnapshot('%s')\n", snapshotFilePath.c_str());
+    return this->_WriteSnapshot(snapshotFilePath, mappingFileModificationTime, mappingFileSize);
+}
+
+void CachedResolverContext::_MarkAsLoaded(double mappingFileModificationTime, uint64_t mappingFileSize){
+    data->loadedMappingFileModificationTime = mappingFileModificationTime;
+    data->loadedMappingFileSize = mappingFileSize;
+    data->isEdited = false;
+}
+
+bool CachedResolverContext::_ResolveAndCachePairViaHook(const std::string& assetPath, std::string* resolvedPath) const{
+    const CachedResolverNativeHooks* nativeHooks = CachedResolverNativeHooks::Get();
+    if (nativeHooks && nativeHooks->HasResolveAndCache()){
+        CachedResolverStatistics::Add(ResolverStatistic::NativeCallCount);
+        const CachedResolverStatistics::Clock::time_point nativeStartTime = CachedResolverStatistics::Clock::now();
+        bool state = nativeHooks->ResolveAndCache(this, assetPath, resolvedPath);
+        CachedResolverStatistics::AddTime(ResolverStatistic::NativeTime, nativeStartTime);
+        if (!state) {
+            std::cerr << "Failed to call the native ResolverContext.ResolveAndCache hook for '" << assetPath << "'." << std::endl;
         }
+        return state;
+    }
+    CachedResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const CachedResolverStatistics::Clock::time_point pythonStartTime = CachedResolverStatistics::Clock::now();
+    bool state = g_resolver_context_resolve_and_cache_hook.CallAndExtract(resolvedPath, this, assetPath);
+    CachedResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
+    if (!state) {
+        std::cerr << "Failed to call Resolver.ResolveAndCache in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
+        std::cerr << "Please verify that the python code is valid!" << std::endl;
     }
+    return state;
 }
 
 const std::string CachedResolverContext::ResolveAndCachePair(const std::string& assetPath) const{
-    std::string pythonResult;
+    /*
+    Is this approach in general a hacky solution? Yes, we are circumventing C++'s
+    'constants' mechanism by redirecting our queries into Python in which we 
+    write-access our Resolver Context. This way we can modify our 'const' C++ read
+    locked resolver context. While it works, be aware that potential side effects may occur.
+    This allows us to populate multiple cachePairs to allow for batch loading.
+
+    Instead of serializing all queries, we only de-duplicate queries per context and
+    asset path. The first thread that misses an asset path runs the Python query,
+    all other threads missing the same asset path wait on its result. Queries for other
+    asset paths or other contexts don't block each other (apart from Python's GIL).
+    */
+    using Clock = std::chrono::steady_clock;
+    CachedResolverContextQueryStatistics& statistics = data->queryStatistics;
+    std::promise<std::string> queryPromise;
+    std::shared_future<std::string> queryFuture;
+    bool isQueryOwner = false;
     {
-        /*
-        We perform the resource/thread lock in the context itself to 
-        allow for resolver multithreading with different contexts.
-        Is this approach in general a hacky solution? Yes, we are circumventing C++'s
-        'constants' mechanism by redirecting our queries into Python in which we 
-        write-access our Resolver Context. This way we can modify our 'const' C++ read
-        locked resolver context. While it works, be aware that potential side effects may occur.
-        This allows us to populate multiple cachePairs to allow for batch loading.
-        */
-        const std::lock_guard<std::mutex> lock(g_resolver_query_mutex);
+        const Clock::time_point lockStartTime = Clock::now();
+        const std::lock_guard<std::mutex> lock(data->inFlightQueriesMutex);
+        const uint64_t lockTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - lockStartTime).count();
+        statistics.lockWaitTimeNs += lockTimeNs;
+        CachedResolverStatistics::Add(ResolverStatistic::LockWaitTime, lockTimeNs);
+        auto query_find = data->inFlightQueries.find(assetPath);
+        if (query_find != data->inFlightQueries.end()){
+            queryFuture = query_find->second;
+        }else{
+            isQueryOwner = true;
+            queryFuture = queryPromise.get_future().share();
+            data->inFlightQueries.emplace(assetPath, queryFuture);
+        }
+    }
+    if (!isQueryOwner){
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolveAndCachePair('%s') - Waiting on in-flight query\n", assetPath.c_str());
+        statistics.deduplicatedQueryCount++;
+        const Clock::time_point waitStartTime = Clock::now();
+        const std::string& queryResult = queryFuture.get();
+        const uint64_t waitTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - waitStartTime).count();
+        statistics.lockWaitTimeNs += waitTimeNs;
+        CachedResolverStatistics::Add(ResolverStatistic::LockWaitTime, waitTimeNs);
+        return queryResult;
+    }
 
+    std::string pythonResult;
+    // Another thread might have finished the same query between our cache lookup and registering the query.
+    CachedResolverContextEntryPtr cachedEntry = this->FindCachingEntry(assetPath);
+    const std::shared_ptr<const std::string> sharedMemoryCacheKey = std::atomic_load(&data->sharedMemoryCacheKey);
+    CachedResolverSharedMemoryCache* sharedMemoryCache = sharedMemoryCacheKey ? CachedResolverSharedMemoryCache::Get() : nullptr;
+    if (cachedEntry){
+        pythonResult = cachedEntry->targetStr;
+    }else if (sharedMemoryCache && sharedMemoryCache->Find(*sharedMemoryCacheKey, assetPath, &pythonResult)){
+        // Another process on this node already queried this asset path.
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolveAndCachePair('%s') - Shared memory cache hit\n", assetPath.c_str());
+        statistics.sharedMemoryHitCount++;
+        data->cachingPairs.InsertOrAssign(assetPath, _CreateEntry(pythonResult, data->cachingEpoch));
+        data->hasUnsavedCachingPairs = true;
+    }else{
         TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolveAndCachePair('%s')\n", assetPath.c_str());
-        
-        int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                         "ResolverContext.ResolveAndCache",
-                                         &pythonResult, this, assetPath);
-        if (!state) {
-            std::cerr << "Failed to call Resolver.ResolveAndCache in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
-            std::cerr << "Please verify that the python code is valid!" << std::endl;
+        statistics.queryCount++;
+        int state = this->_ResolveAndCachePairViaHook(assetPath, &pythonResult);
+        if (state && sharedMemoryCache && !pythonResult.empty()){
+            sharedMemoryCache->Insert(*sharedMemoryCacheKey, assetPath, pythonResult);
         }
     }
+    queryPromise.set_value(pythonResult);
+    {
+        const std::lock_guard<std::mutex> lock(data->inFlightQueriesMutex);
+        data->inFlightQueries.erase(assetPath);
+    }
     return pythonResult;
-}
\ No newline at end of file
+}
+
+void CachedResolverContext::ResolveAndCachePairs(const std::vector<std::string>& assetPaths) const{
+    /*
+    This batches the queries of multiple asset paths into a single Python call
+    (or parallel native calls, if a native hook library is loaded).
+    Asset paths that are mapped, prefix mapped, cached, covered by a resolve rule
+    or are currently being queried are skipped, all others are registered as
+    in-flight queries, so that concurrent single queries of the same asset paths
+    wait on the batch instead of querying again. Like single queries, shared
+    memory cache hits are cached directly, only the misses are passed to the hook.
+    The Python hook has to add the results via context.AddCachingPair, we then
+    serve the results from the caching pairs.
+    */
+    using Clock = std::chrono::steady_clock;
+    CachedResolverContextQueryStatistics& statistics = data->queryStatistics;
+    // Asset paths that _Resolve serves without the hook must not be batched, otherwise
+    // the hook results (stored as caching pairs) would shadow the prefix mapping/rule results.
+    std::vector<const std::string*> pendingAssetPaths;
+    pendingAssetPaths.reserve(assetPaths.size());
+    for (const std::string& assetPath : assetPaths){
+        if (this->FindMappingEntry(assetPath) || this->FindPrefixMappingEntry(assetPath) ||
+            this->FindCachingEntry(assetPath) || this->ResolveAndCachePairFromRules(assetPath)){
+            continue;
+        }
+        pendingAssetPaths.push_back(&assetPath);
+    }
+    if (pendingAssetPaths.empty()){
+        return;
+    }
+    std::vector<std::string> queryAssetPaths;
+    std::vector<std::promise<std::string>> queryPromises;
+    {
+        const Clock::time_point lockStartTime = Clock::now();
+        const std::lock_guard<std::mutex> lock(data->inFlightQueriesMutex);
+        const uint64_t lockTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - lockStartTime).count();
+        statistics.lockWaitTimeNs += lockTimeNs;
+        CachedResolverStatistics::Add(ResolverStatistic::LockWaitTime, lockTimeNs);
+        queryAssetPaths.reserve(pendingAssetPaths.size());
+        queryPromises.reserve(pendingAssetPaths.size());
+        for (const std::string* assetPath : pendingAssetPaths){
+            // Another thread might have finished the same query in the meantime.
+            if (this->FindCachingEntry(*assetPath)){
+                continue;
+            }
+            if (data->inFlightQueries.find(*assetPath) != data->inFlightQueries.end()){
+                continue;
+            }
+            queryPromises.emplace_back();
+            data->inFlightQueries.emplace(*assetPath, queryPromises.back().get_future().share());
+            queryAssetPaths.push_back(*assetPath);
+        }
+    }
+    if (queryAssetPaths.empty()){
+        return;
+    }
+    // Asset paths that another process on this node already queried are served by the shared memory cache.
+    const std::shared_ptr<const std::string> sharedMemoryCacheKey = std::atomic_load(&data->sharedMemoryCacheKey);
+    CachedResolverSharedMemoryCache* sharedMemoryCache = sharedMemoryCacheKey ? CachedResolverSharedMemoryCache::Get() : nullptr;
+    std::vector<std::string> hookAssetPaths;
+    hookAssetPaths.reserve(queryAssetPaths.size());
+    for (const std::string& assetPath : queryAssetPaths){
+        std::string sharedMemoryResult;
+        if (sharedMemoryCache && sharedMemoryCache->Find(*sharedMemoryCacheKey, assetPath, &sharedMemoryResult)){
+            statistics.sharedMemoryHitCount++;
+            data->cachingPairs.InsertOrAssign(assetPath, _CreateEntry(sharedMemoryResult, data->cachingEpoch));
+            data->hasUnsavedCachingPairs = true;
+        }else{
+            hookAssetPaths.push_back(assetPath);
+        }
+    }
+    if (!hookAssetPaths.empty()){
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolveAndCachePairs(%zu asset paths)\n", hookAssetPaths.size());
+        statistics.queryCount++;
+        std::vector<char> states(hookAssetPaths.size(), 0);
+        const CachedResolverNativeHooks* nativeHooks = CachedResolverNativeHooks::Get();
+        if (nativeHooks && nativeHooks->HasResolveAndCache()){
+            // There is no native batch hook, as without the GIL we can just query the asset paths in parallel.
+            WorkParallelForN(hookAssetPaths.size(), [this, &hookAssetPaths, &states](size_t begin, size_t end){
+                for (size_t i = begin; i < end; i++){
+                    std::string resolvedPath;
+                    states[i] = this->_ResolveAndCachePairViaHook(hookAssetPaths[i], &resolvedPath);
+                }
+            });
+        }else{
+            CachedResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+            const CachedResolverStatistics::Clock::time_point pythonStartTime = CachedResolverStatistics::Clock::now();
+            int state = g_resolver_context_resolve_and_cache_batch_hook.Call(this, hookAssetPaths);
+            CachedResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
+            if (!state) {
+                std::cerr << "Failed to call ResolverContext.ResolveAndCacheBatch in " << DEFINE_STRING(AR_CACHEDRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
+                std::cerr << "Please verify that the python code is valid!" << std::endl;
+            }
+            std::fill(states.begin(), states.end(), state ? 1 : 0);
+        }
+        if (sharedMemoryCache){
+            for (size_t i = 0; i < hookAssetPaths.size(); i++){
+                CachedResolverContextEntryPtr cachedEntry = this->FindCachingEntry(hookAssetPaths[i]);
+                if (states[i] && cachedEntry && !cachedEntry->targetStr.empty()){
+                    sharedMemoryCache->Insert(*sharedMemoryCacheKey, hookAssetPaths[i], cachedEntry->targetStr);
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < queryAssetPaths.size(); i++){
+        CachedResolverContextEntryPtr cachedEntry = this->FindCachingEntry(queryAssetPaths[i]);
+        queryPromises[i].set_value(cachedEntry ? cachedEntry->targetStr : std::string());
+    }
+    {
+        const std::lock_guard<std::mutex> lock(data->inFlightQueriesMutex);
+        for (const std::string& assetPath : queryAssetPaths){
+            data->inFlightQueries.erase(assetPath);
+        }
+    }
+}
+
+const std::map<std::string, double> CachedResolverContext::GetQueryStatistics() const{
+    const CachedResolverContextQueryStatistics& statistics = data->queryStatistics;
+    return std::map<std::string, double>{
+        {"queryCount", static_cast<double>(statistics.queryCount.load())},
+        {"deduplicatedQueryCount", static_cast<double>(statistics.deduplicatedQueryCount.load())},
+        {"lockWaitTime", static_cast<double>(statistics.lockWaitTimeNs.load()) * 1e-9},
+        {"sharedMemoryHitCount", static_cast<double>(statistics.sharedMemoryHitCount.load())}
+    };
+}
+
+void CachedResolverContext::ResetQueryStatistics(){
+    CachedResolverContextQueryStatistics& statistics = data->queryStatistics;
+    statistics.queryCount = 0;
+    statistics.deduplicatedQueryCount = 0;
+    statistics.lockWaitTimeNs = 0;
+    statistics.sharedMemoryHitCount = 0;
+}
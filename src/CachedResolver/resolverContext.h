@@ -3,15 +3,30 @@
 
 #include "api.h"
 #include "debugCodes.h"
+#include "resolverContextSnapshot.h"
 
 #include "pxr/pxr.h"
 #include "pxr/usd/ar/defineResolverContext.h"
+#include "pxr/usd/ar/resolvedPath.h"
 #include "pxr/usd/ar/resolverContext.h"
 
+#include "concurrent_string_map.h"
+#include "pattern_rules.h"
+#include "prefix_trie.h"
+#include "resolver_statistics.h"
+
+#include <atomic>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <regex>
+#include <shared_mutex>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /* Data Model
 We use an internal data struct that is accessed via a shared pointer
@@ -20,12 +35,80 @@ instead of passing thru the pointer. This way we can send
 > ArNotice::ResolverChanged(*ctx).Send();
 notifications to the stages.
 > See for more info: https://groups.google.com/g/usd-interest/c/9JrXGGbzBnQ/m/_f3oaqBdAwAJ
+The pairs are stored in concurrent maps, as the resolver reads them from multiple threads
+while Python populates them on cache misses.
+*/
+
+/* Pair Entries
+Each mapping/caching pair value is stored as an immutable entry, that besides the
+target path also stores the validated absolute resolved path (empty if the target
+doesn't exist) and when/in which cache scope it was validated. This way cache hits
+can return the resolved path without any file system access. Entries are swapped
+out atomically when the resolver (re-)validates them, see CachedResolver::_Resolve.
+Entries are tagged with the epoch of their map at creation time. Clearing the mapping/prefix mapping/caching
+pairs only bumps the epoch (so readers never see a half cleared map), entries of older
+epochs are treated as missing and get freed by a background task.
 */
+struct CachedResolverContextEntry
+{
+    std::string targetStr;
+    bool isValidated{false};
+    PXR_NS::ArResolvedPath resolvedPath;
+    double validationTime{0.0};
+    uint64_t validationScopeId{0};
+    uint64_t epoch{0};
+};
+
+using CachedResolverContextEntryPtr = std::shared_ptr<const CachedResolverContextEntry>;
+
+struct CachedResolverContextQueryStatistics
+{
+    std::atomic<uint64_t> queryCount{0};
+    std::atomic<uint64_t> deduplicatedQueryCount{0};
+    std::atomic<uint64_t> lockWaitTimeNs{0};
+    std::atomic<uint64_t> sharedMemoryHitCount{0};
+};
+
 struct CachedResolverContextInternalData
 {
     std::string mappingFilePath;
-    std::map<std::string, std::string> mappingPairs;
-    std::map<std::string, std::string> cachingPairs;
+    ConcurrentStringMap<CachedResolverContextEntryPtr> mappingPairs;
+    ConcurrentStringMap<CachedResolverContextEntryPtr> cachingPairs;
+    std::atomic<uint64_t> mappingEpoch{0};
+    std::atomic<uint64_t> cachingEpoch{0};
+    // Cache misses that are currently queried, concurrent misses on the same path wait on the shared result.
+    std::mutex inFlightQueriesMutex;
+    std::unordered_map<std::string, std::shared_future<std::string>> inFlightQueries;
+    CachedResolverContextQueryStatistics queryStatistics;
+    // The resolved paths of the layers whose dependencies were already batch queried.
+    ConcurrentStringMap<bool> batchedLayers;
+    // Read-only base layers below the maps, pairs are copied into the maps on their first hit
+    // and removed snapshot pairs are stored as tombstones (nullptr entries).
+    CachedResolverContextSnapshotPtr mappingSnapshot;
+    CachedResolverContextSnapshotPtr cachingSnapshot;
+    // A longest prefix match costs O(path length), the count allows skipping the lock if there are no prefixes.
+    mutable std::shared_mutex prefixMappingPairsMutex;
+    PrefixTrie<std::string> prefixMappingPairs;
+    std::atomic<size_t> prefixMappingPairCount{0};
+    // The validated prefix mapped targets per asset path, invalidated by bumping prefixMappingEpoch.
+    ConcurrentStringMap<CachedResolverContextEntryPtr> prefixMappingEntries;
+    std::atomic<uint64_t> prefixMappingEpoch{0};
+    // Regex/format pairs for anchored relative paths, their results (including misses) are cached per context.
+    PatternRules identifierTemplates{8192};
+    // Regex/format pairs that are matched against cache misses before calling into Python.
+    PatternRules resolveRules;
+    // The pairs changed by ReloadFromMappingFilePath, consumed by the resolver to only reload the affected layers.
+    std::mutex changedPairsMutex;
+    std::optional<std::map<std::string, std::string>> changedPairs;
+    bool isFullReloadPending{false};
+    // Identifies the mapping file content in the shared memory cache, dropped once the pairs diverge from it.
+    std::shared_ptr<const std::string> sharedMemoryCacheKey;
+    // Caching pairs that were added since the snapshot was written get persisted by FlushSnapshot.
+    std::atomic<bool> hasUnsavedCachingPairs{false};
+    // Removed mapping data (e.g. via RemoveMappingByKey) doesn't match the mapping file anymore, so it is never flushed.
+    std::atomic<bool> isEdited{false};
+    std::atomic<double> loadedMappingFileModificationTime{0.0};
+    std::atomic<uint64_t> loadedMappingFileSize{0};
 };
 
 class CachedResolverContext
@@ -38,6 +121,8 @@ public:
     CachedResolverContext(const CachedResolverContext& ctx);
     AR_CACHEDRESOLVER_API
     CachedResolverContext(const std::string& mappingFilePath);
+    AR_CACHEDRESOLVER_API
+    ~CachedResolverContext();
     
     // Standard Ops
     AR_CACHEDRESOLVER_API
@@ -50,6 +135,9 @@ public:
     friend size_t hash_value(const CachedResolverContext& ctx);
 
     // Methods
+    // Returns true if a copy of this context exists (e.g. bound to a stage).
+    AR_CACHEDRESOLVER_API
+    bool IsShared() const { return data.use_count() > 1; }
     AR_CACHEDRESOLVER_API
     void Initialize();
     AR_CACHEDRESOLVER_API
@@ -61,15 +149,55 @@ public:
     AR_CACHEDRESOLVER_API
     void RefreshFromMappingFilePath();
     AR_CACHEDRESOLVER_API
+    bool ReloadFromMappingFilePath();
+    AR_CACHEDRESOLVER_API
+    bool TakeChangedPairs(std::map<std::string, std::string>* changedPairs) const;
+    AR_CACHEDRESOLVER_API
     void AddMappingPair(const std::string& sourceStr, const std::string& targetStr);
     AR_CACHEDRESOLVER_API
     void RemoveMappingByKey(const std::string& sourceStr);
     AR_CACHEDRESOLVER_API
     void RemoveMappingByValue(const std::string& targetStr);
     AR_CACHEDRESOLVER_API
-    const std::map<std::string, std::string>& GetMappingPairs() const { return data->mappingPairs; }
+    CachedResolverContextEntryPtr FindMappingEntry(const std::string& sourceStr) const;
+    AR_CACHEDRESOLVER_API
+    void UpdateMappingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const;
+    AR_CACHEDRESOLVER_API
+    const std::map<std::string, std::string> GetMappingPairs() const;
+    AR_CACHEDRESOLVER_API
+    void ClearMappingPairs();
+    AR_CACHEDRESOLVER_API
+    void AddPrefixMappingPair(const std::string& sourcePrefixStr, const std::string& targetPrefixStr);
+    AR_CACHEDRESOLVER_API
+    void RemovePrefixMappingByKey(const std::string& sourcePrefixStr);
+    AR_CACHEDRESOLVER_API
+    const std::map<std::string, std::string> GetPrefixMappingPairs() const;
+    AR_CACHEDRESOLVER_API
+    void ClearPrefixMappingPairs();
     AR_CACHEDRESOLVER_API
-    void ClearMappingPairs() { data->mappingPairs.clear(); }
+    bool FindPrefixMapping(const std::string& sourceStr, std::string* targetStr) const;
+    AR_CACHEDRESOLVER_API
+    CachedResolverContextEntryPtr FindPrefixMappingEntry(const std::string& sourceStr) const;
+    AR_CACHEDRESOLVER_API
+    void UpdatePrefixMappingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const;
+    AR_CACHEDRESOLVER_API
+    bool AddIdentifierTemplate(const std::string& regexExpressionStr, const std::string& formatStr);
+    AR_CACHEDRESOLVER_API
+    const std::vector<std::pair<std::string, std::string>> GetIdentifierTemplates() const;
+    AR_CACHEDRESOLVER_API
+    void ClearIdentifierTemplates();
+    AR_CACHEDRESOLVER_API
+    bool FindIdentifierTemplateMatch(const std::string& anchoredAssetPath, std::string* identifier) const;
+    AR_CACHEDRESOLVER_API
+    bool AddResolveRule(const std::string& regexExpressionStr, const std::string& formatStr);
+    AR_CACHEDRESOLVER_API
+    const std::vector<std::pair<std::string, std::string>> GetResolveRules() const;
+    AR_CACHEDRESOLVER_API
+    void ClearResolveRules();
+    AR_CACHEDRESOLVER_API
+    CachedResolverContextEntryPtr ResolveAndCachePairFromRules(const std::string& assetPath) const;
+    AR_CACHEDRESOLVER_API
+    const std::string ResolveLatestVersion(const std::string& filePathPattern) const;
     AR_CACHEDRESOLVER_API
     void AddCachingPair(const std::string& sourceStr, const std::string& targetStr);
     AR_CACHEDRESOLVER_API
@@ -77,17 +205,43 @@ public:
     AR_CACHEDRESOLVER_API
     void RemoveCachingByValue(const std::string& targetStr);
     AR_CACHEDRESOLVER_API
-    const std::map<std::string, std::string>& GetCachingPairs() const { return data->cachingPairs; }
+    CachedResolverContextEntryPtr FindCachingEntry(const std::string& sourceStr) const;
+    AR_CACHEDRESOLVER_API
+    void UpdateCachingEntry(const std::string& sourceStr, const CachedResolverContextEntryPtr& entry, const CachedResolverContextEntryPtr& validatedEntry) const;
+    AR_CACHEDRESOLVER_API
+    const std::map<std::string, std::string> GetCachingPairs() const;
     AR_CACHEDRESOLVER_API
-    void ClearCachingPairs() { data->cachingPairs.clear(); }
+    void ClearCachingPairs();
     AR_CACHEDRESOLVER_API
     const std::string ResolveAndCachePair(const std::string& assetPath) const;
+    AR_CACHEDRESOLVER_API
+    void ResolveAndCachePairs(const std::vector<std::string>& assetPaths) const;
+    AR_CACHEDRESOLVER_API
+    bool MarkLayerAsBatched(const std::string& layerPath) const { return data->batchedLayers.Insert(layerPath, true); }
+    AR_CACHEDRESOLVER_API
+    const std::map<std::string, double> GetQueryStatistics() const;
+    AR_CACHEDRESOLVER_API
+    void ResetQueryStatistics();
+    AR_CACHEDRESOLVER_API
+    bool SaveSnapshot() const;
+    AR_CACHEDRESOLVER_API
+    bool FlushSnapshot() const;
 
 private:
     std::shared_ptr<CachedResolverContextInternalData> data = std::make_shared<CachedResolverContextInternalData>();
     bool _GetMappingPairsFromUsdFile(const std::string& filePath);
+    bool _GetSnapshotFilePath(std::string* snapshotFilePath, double* mappingFileModificationTime, uint64_t* mappingFileSize) const;
+    bool _LoadSnapshot(const std::string& snapshotFilePath, double mappingFileModificationTime, uint64_t mappingFileSize);
+    bool _WriteSnapshot(const std::string& snapshotFilePath, double mappingFileModificationTime, uint64_t mappingFileSize) const;
+    void _MarkAsLoaded(double mappingFileModificationTime, uint64_t mappingFileSize);
+    bool _ResolveAndCachePairViaHook(const std::string& assetPath, std::string* resolvedPath) const;
+    void _AttachSharedMemoryCache();
+    void _DetachSharedMemoryCache();
 };
 
+// The statistics are keyed by the context type, so that each resolver plugin gets its own counters.
+using CachedResolverStatistics = ResolverStatistics<CachedResolverContext>;
+
 PXR_NAMESPACE_OPEN_SCOPE
 AR_DECLARE_RESOLVER_CONTEXT(CachedResolverContext);
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,295 @@
+#include "resolverContextSnapshot.h"
+#include "debugCodes.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/defines.h"
+#include "pxr/base/tf/debug.h"
+#include "pxr/base/tf/fileUtils.h"
+#include "pxr/base/tf/pathUtils.h"
+#include "pxr/base/tf/stringUtils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(ARCH_OS_WINDOWS)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+static const char g_snapshot_magic[8] = {'A', 'R', 'C', 'S', 'N', 'A', 'P', '\0'};
+static const uint32_t g_snapshot_version = 5;
+
+static long long
+_GetProcessId()
+{
+#if defined(ARCH_OS_WINDOWS)
+    return static_cast<long long>(_getpid());
+#else
+    return static_cast<long long>(getpid());
+#endif
+}
+
+static uint64_t
+_Fnv1aHash(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void
+_PadBuffer(std::string& buffer)
+{
+    // Keep all tables 8 byte aligned, so that we can access them directly in the mapping.
+    buffer.append((8 - buffer.size() % 8) % 8, '\0');
+}
+
+std::string
+CachedResolverContextSnapshot::GetSnapshotFilePath(
+    const std::string& snapshotDirPath,
+    const std::string& mappingFilePath)
+{
+    // This has to be stable across processes, so we don't use std::hash/TfHash here.
+    const uint64_t hash = _Fnv1aHash(mappingFilePath.data(), mappingFilePath.size());
+    return TfStringCatPaths(snapshotDirPath, TfStringPrintf("%016llx.arsnapshot", static_cast<unsigned long long>(hash)));
+}
+
+CachedResolverContextSnapshotPtr
+CachedResolverContextSnapshot::Open(
+    const std::string& snapshotFilePath,
+    const std::string& mappingFilePath,
+    double mappingFileModificationTime,
+    uint64_t mappingFileSize,
+    bool verifyChecksum)
+{
+    if (!TfIsFile(snapshotFilePath)) {
+        return nullptr;
+    }
+    std::string errMsg;
+    ArchConstFileMapping mapping = ArchMapFileReadOnly(snapshotFilePath, &errMsg);
+    if (!mapping) {
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContextSnapshot::Open('%s') - Failed to map file: %s\n",
+                                                      snapshotFilePath.c_str(), errMsg.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<CachedResolverContextSnapshot> snapshot(new CachedResolverContextSnapshot());
+    snapshot->_size = ArchGetFileMappingLength(mapping);
+    snapshot->_data = mapping.get();
+    snapshot->_mapping = std::move(mapping);
+    if (!snapshot->_Validate(mappingFilePath, mappingFileModificationTime, mappingFileSize)) {
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContextSnapshot::Open('%s') - Stale or corrupt snapshot\n",
+                                                      snapshotFilePath.c_str());
+        return nullptr;
+    }
+    if (verifyChecksum && !snapshot->VerifyChecksum()) {
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContextSnapshot::Open('%s') - Checksum mismatch\n",
+                                                      snapshotFilePath.c_str());
+        return nullptr;
+    }
+    return snapshot;
+}
+
+bool
+CachedResolverContextSnapshot::VerifyChecksum() const
+{
+    // This reads the whole file, so it isn't part of the validation on open.
+    _Header header;
+    std::memcpy(&header, _data, sizeof(_Header));
+    return _Fnv1aHash(_data + sizeof(_Header), _size - sizeof(_Header)) == header.checksum;
+}
+
+bool
+CachedResolverContextSnapshot::_Validate(
+    const std::string& mappingFilePath,
+    double mappingFileModificationTime,
+    uint64_t mappingFileSize)
+{
+    if (_size < sizeof(_Header)) {
+        return false;
+    }
+    _Header header;
+    std::memcpy(&header, _data, sizeof(_Header));
+    if (std::memcmp(header.magic, g_snapshot_magic, sizeof(g_snapshot_magic)) != 0 ||
+        header.version != g_snapshot_version ||
+        header.sectionCount != SectionCount ||
+        header.fileSize != _size) {
+        return false;
+    }
+    if (header.mappingFileModificationTime != mappingFileModificationTime ||
+        header.mappingFileSize != mappingFileSize ||
+        header.mappingFilePathSize != mappingFilePath.size() ||
+        sizeof(_Header) + header.mappingFilePathSize > _size ||
+        std::memcmp(_data + sizeof(_Header), mappingFilePath.data(), mappingFilePath.size()) != 0) {
+        return false;
+    }
+    // Bounds check all tables, so that lookups don't have to.
+    size_t sectionsOffset = sizeof(_Header) + header.mappingFilePathSize;
+    sectionsOffset += (8 - sectionsOffset % 8) % 8;
+    if (sectionsOffset + sizeof(_SectionHeader) * SectionCount > _size) {
+        return false;
+    }
+    _sections = reinterpret_cast<const _SectionHeader*>(_data + sectionsOffset);
+    for (uint32_t section = 0; section < SectionCount; section++) {
+        const _SectionHeader& sectionHeader = _sections[section];
+        if (sectionHeader.recordsOffset % 8 != 0 ||
+            sectionHeader.recordsOffset > _size ||
+            sectionHeader.pairCount > (_size - sectionHeader.recordsOffset) / sizeof(_PairRecord)) {
+            return false;
+        }
+        const _PairRecord* records = this->_GetRecords(static_cast<Section>(section));
+        for (size_t i = 0; i < sectionHeader.pairCount; i++) {
+            const _PairRecord& record = records[i];
+            if (record.keyOffset > _size || record.keySize > _size - record.keyOffset ||
+                record.valueOffset > _size || record.valueSize > _size - record.valueOffset) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const CachedResolverContextSnapshot::_PairRecord*
+CachedResolverContextSnapshot::_GetRecords(Section section) const
+{
+    return reinterpret_cast<const _PairRecord*>(_data + _sections[section].recordsOffset);
+}
+
+size_t
+CachedResolverContextSnapshot::GetPairCount(Section section) const
+{
+    return _sections[section].pairCount;
+}
+
+bool
+CachedResolverContextSnapshot::Find(
+    Section section,
+    const std::string& key,
+    std::string_view* value) const
+{
+    // The records are sorted by key, see Write. This isn't the case for the identifier templates/resolve rules sections.
+    const _PairRecord* records = this->_GetRecords(section);
+    size_t low = 0;
+    size_t high = this->GetPairCount(section);
+    const std::string_view keyView(key);
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        const int compare = this->_GetKey(records[middle]).compare(keyView);
+        if (compare == 0) {
+            *value = this->_GetValue(records[middle]);
+            return true;
+        } else if (compare < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+bool
+CachedResolverContextSnapshot::Write(
+    const std::string& snapshotFilePath,
+    const std::string& mappingFilePath,
+    double mappingFileModificationTime,
+    uint64_t mappingFileSize,
+    const std::map<std::string, std::string>& mappingPairs,
+    const std::map<std::string, std::string>& cachingPairs,
+    const std::map<std::string, std::string>& prefixMappingPairs,
+    const std::vector<std::pair<std::string, std::string>>& identifierTemplates,
+    const std::vector<std::pair<std::string, std::string>>& resolveRules)
+{
+    // The map sections are sorted by key, the identifier templates/resolve rules keep their priority order.
+    std::vector<std::pair<const std::string*, const std::string*>> sectionPairs[SectionCount];
+    const std::map<std::string, std::string>* sortedSectionPairs[PrefixMappingPairs + 1] = {&mappingPairs, &cachingPairs, &prefixMappingPairs};
+    for (uint32_t section = 0; section <= PrefixMappingPairs; section++) {
+        sectionPairs[section].reserve(sortedSectionPairs[section]->size());
+        for (const auto& pair : *sortedSectionPairs[section]) {
+            sectionPairs[section].emplace_back(&pair.first, &pair.second);
+        }
+    }
+    for (const auto& pair : identifierTemplates) {
+        sectionPairs[IdentifierTemplates].emplace_back(&pair.first, &pair.second);
+    }
+    for (const auto& pair : resolveRules) {
+        sectionPairs[ResolveRules].emplace_back(&pair.first, &pair.second);
+    }
+    // Layout: Header | Mapping File Path | Section Headers | Records | String Blob
+    std::string buffer(sizeof(_Header), '\0');
+    buffer.append(mappingFilePath);
+    _PadBuffer(buffer);
+    const size_t sectionsOffset = buffer.size();
+    buffer.append(sizeof(_SectionHeader) * SectionCount, '\0');
+    std::vector<_SectionHeader> sections(SectionCount);
+    for (uint32_t section = 0; section < SectionCount; section++) {
+        sections[section].pairCount = sectionPairs[section].size();
+        sections[section].recordsOffset = buffer.size();
+        buffer.append(sizeof(_PairRecord) * sectionPairs[section].size(), '\0');
+    }
+    std::memcpy(&buffer[sectionsOffset], sections.data(), sizeof(_SectionHeader) * SectionCount);
+    for (uint32_t section = 0; section < SectionCount; section++) {
+        size_t recordOffset = sections[section].recordsOffset;
+        for (const auto& pair : sectionPairs[section]) {
+            _PairRecord record;
+            record.keyOffset = buffer.size();
+            record.keySize = static_cast<uint32_t>(pair.first->size());
+            buffer.append(*pair.first);
+            record.valueOffset = buffer.size();
+            record.valueSize = static_cast<uint32_t>(pair.second->size());
+            buffer.append(*pair.second);
+            std::memcpy(&buffer[recordOffset], &record, sizeof(_PairRecord));
+            recordOffset += sizeof(_PairRecord);
+        }
+    }
+    _Header header;
+    std::memcpy(header.magic, g_snapshot_magic, sizeof(g_snapshot_magic));
+    header.version = g_snapshot_version;
+    header.sectionCount = SectionCount;
+    header.mappingFileModificationTime = mappingFileModificationTime;
+    header.mappingFileSize = mappingFileSize;
+    header.fileSize = buffer.size();
+    header.checksum = _Fnv1aHash(buffer.data() + sizeof(_Header), buffer.size() - sizeof(_Header));
+    header.mappingFilePathSize = mappingFilePath.size();
+    std::memcpy(&buffer[0], &header, sizeof(_Header));
+
+    // Write to a process/thread unique temp file and then rename it, so that
+    // readers in other processes never see a partially written snapshot.
+    const std::string snapshotDirPath = TfGetPathName(snapshotFilePath);
+    if (!snapshotDirPath.empty() && !TfIsDir(snapshotDirPath) && !TfMakeDirs(snapshotDirPath, -1, true)) {
+        return false;
+    }
+    const std::string tmpFilePath = TfStringPrintf("%s.%lld.%zu.%lld.tmp", snapshotFilePath.c_str(),
+        _GetProcessId(),
+        std::hash<std::thread::id>()(std::this_thread::get_id()),
+        static_cast<long long>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    {
+        std::ofstream tmpFile(tmpFilePath, std::ios::binary | std::ios::trunc);
+        if (!tmpFile.write(buffer.data(), buffer.size())) {
+            tmpFile.close();
+            std::remove(tmpFilePath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmpFilePath.c_str(), snapshotFilePath.c_str()) != 0) {
+        // Windows doesn't replace existing files on rename.
+        std::remove(snapshotFilePath.c_str());
+        if (std::rename(tmpFilePath.c_str(), snapshotFilePath.c_str()) != 0) {
+            std::remove(tmpFilePath.c_str());
+            return false;
+        }
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContextSnapshot::Write('%s') - %zu mapping pairs, %zu caching pairs, %zu prefix mapping pairs, %zu identifier templates, %zu resolve rules\n",
+                                                  snapshotFilePath.c_str(), mappingPairs.size(), cachingPairs.size(), prefixMappingPairs.size(),
+                                                  identifierTemplates.size(), resolveRules.size());
+    return true;
+}
@@ -0,0 +1,124 @@
+#ifndef AR_CACHEDRESOLVER_RESOLVER_CONTEXT_SNAPSHOT_H
+#define AR_CACHEDRESOLVER_RESOLVER_CONTEXT_SNAPSHOT_H
+
+#include "api.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/fileSystem.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/* Snapshot
+A snapshot persists the (prefix) mapping/caching pairs, identifier templates and resolve rules of a resolver context to disk,
+so that other processes opening the same mapping file can skip the (Python)
+initialization and cache warm-up. Snapshots are keyed by the mapping file path
+and its modification time and size, a changed mapping file invalidates the snapshot.
+
+The file consists of a header, a sorted record table per section and a string blob.
+Snapshots are memory mapped read-only, lookups binary search the record table
+and return string views into the mapping, so nothing gets copied until a pair is hit.
+Opening a snapshot only validates the header key (format version, mapping file
+modification time/size, payload size) and bounds checks the tables, so that the
+open cost doesn't scale with the string blob size. Snapshots that are stale or
+truncated are rejected on open. The payload checksum is only verified on request
+(see VerifyChecksum), e.g. when debugging corrupt snapshots.
+*/
+class CachedResolverContextSnapshot
+{
+public:
+    enum Section : uint32_t
+    {
+        MappingPairs = 0,
+        CachingPairs = 1,
+        PrefixMappingPairs = 2,
+        // Ordered by priority instead of by key, so these can only be iterated via ForEach.
+        IdentifierTemplates = 3,
+        ResolveRules = 4,
+        SectionCount = 5
+    };
+
+    AR_CACHEDRESOLVER_API
+    static std::string GetSnapshotFilePath(const std::string& snapshotDirPath,
+                                           const std::string& mappingFilePath);
+    AR_CACHEDRESOLVER_API
+    static std::shared_ptr<const CachedResolverContextSnapshot> Open(const std::string& snapshotFilePath,
+                                                                     const std::string& mappingFilePath,
+                                                                     double mappingFileModificationTime,
+                                                                     uint64_t mappingFileSize,
+                                                                     bool verifyChecksum = false);
+    AR_CACHEDRESOLVER_API
+    static bool Write(const std::string& snapshotFilePath,
+                      const std::string& mappingFilePath,
+                      double mappingFileModificationTime,
+                      uint64_t mappingFileSize,
+                      const std::map<std::string, std::string>& mappingPairs,
+                      const std::map<std::string, std::string>& cachingPairs,
+                      const std::map<std::string, std::string>& prefixMappingPairs,
+                      const std::vector<std::pair<std::string, std::string>>& identifierTemplates,
+                      const std::vector<std::pair<std::string, std::string>>& resolveRules);
+
+    AR_CACHEDRESOLVER_API
+    bool Find(Section section, const std::string& key, std::string_view* value) const;
+    AR_CACHEDRESOLVER_API
+    size_t GetPairCount(Section section) const;
+    AR_CACHEDRESOLVER_API
+    bool VerifyChecksum() const;
+
+    template <typename Function>
+    void ForEach(Section section, const Function& function) const
+    {
+        const _PairRecord* records = this->_GetRecords(section);
+        for (size_t i = 0; i < this->GetPairCount(section); i++) {
+            function(this->_GetKey(records[i]), this->_GetValue(records[i]));
+        }
+    }
+
+private:
+    struct _Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        double mappingFileModificationTime;
+        uint64_t mappingFileSize;
+        uint64_t fileSize;
+        uint64_t checksum;
+        uint64_t mappingFilePathSize;
+    };
+
+    struct _SectionHeader
+    {
+        uint64_t pairCount;
+        uint64_t recordsOffset;
+    };
+
+    struct _PairRecord
+    {
+        uint64_t keyOffset;
+        uint64_t valueOffset;
+        uint32_t keySize;
+        uint32_t valueSize;
+    };
+
+    CachedResolverContextSnapshot() = default;
+
+    bool _Validate(const std::string& mappingFilePath, double mappingFileModificationTime, uint64_t mappingFileSize);
+    const _PairRecord* _GetRecords(Section section) const;
+    std::string_view _GetKey(const _PairRecord& record) const { return std::string_view(_data + record.keyOffset, record.keySize); }
+    std::string_view _GetValue(const _PairRecord& record) const { return std::string_view(_data + record.valueOffset, record.valueSize); }
+
+    PXR_NS::ArchConstFileMapping _mapping;
+    const char* _data{nullptr};
+    size_t _size{0};
+    const _SectionHeader* _sections{nullptr};
+};
+
+using CachedResolverContextSnapshotPtr = std::shared_ptr<const CachedResolverContextSnapshot>;
+
+#endif // AR_CACHEDRESOLVER_RESOLVER_CONTEXT_SNAPSHOT_H
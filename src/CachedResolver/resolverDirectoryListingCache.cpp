@@ -0,0 +1,114 @@
+#define CONVERT_STRING(string) #string
+#define DEFINE_STRING(string) CONVERT_STRING(string)
+
+#include "resolverDirectoryListingCache.h"
+#include "debugCodes.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/tf/debug.h"
+#include "pxr/base/tf/getenv.h"
+#include "pxr/base/tf/pathUtils.h"
+#include "pxr/base/tf/stringUtils.h"
+
+#include <algorithm>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+static const std::string g_latest_version_placeholder = "{latest}";
+
+static bool
+_IsDigits(const std::string& str, size_t begin, size_t end)
+{
+    if (begin >= end) {
+        return false;
+    }
+    for (size_t i = begin; i < end; i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int
+_CompareVersions(const std::string& versionA, const std::string& versionB)
+{
+    // Compare numerically without parsing, so that arbitrarily long versions don't overflow.
+    const size_t beginA = std::min(versionA.find_first_not_of('0'), versionA.size());
+    const size_t beginB = std::min(versionB.find_first_not_of('0'), versionB.size());
+    const size_t sizeA = versionA.size() - beginA;
+    const size_t sizeB = versionB.size() - beginB;
+    if (sizeA != sizeB) {
+        return sizeA < sizeB ? -1 : 1;
+    }
+    return versionA.compare(beginA, sizeA, versionB, beginB, sizeB);
+}
+
+CachedResolverDirectoryListingCache&
+CachedResolverDirectoryListingCache::Get()
+{
+    static CachedResolverDirectoryListingCache instance;
+    return instance;
+}
+
+CachedResolverDirectoryListingCache::CachedResolverDirectoryListingCache()
+{
+    this->SetStatInterval(TfGetenvDouble(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_DIRECTORY_LISTING_STAT_INTERVAL), 1.0));
+}
+
+void
+CachedResolverDirectoryListingCache::SetStatInterval(double statInterval)
+{
+    DirectoryIndex::GetInstance().SetStatInterval(statInterval);
+}
+
+void
+CachedResolverDirectoryListingCache::Clear()
+{
+    DirectoryIndex::GetInstance().Clear();
+    _latestVersions.Clear();
+}
+
+std::string
+CachedResolverDirectoryListingCache::FindLatestVersion(const std::string& filePathPattern)
+{
+    const std::string dirPath = TfGetPathName(filePathPattern);
+    const std::string fileNamePattern = TfGetBaseName(filePathPattern);
+    const size_t placeholderIdx = fileNamePattern.find(g_latest_version_placeholder);
+    if (dirPath.empty() || placeholderIdx == std::string::npos) {
+        return std::string();
+    }
+    const std::string fileNamePrefix = fileNamePattern.substr(0, placeholderIdx);
+    const std::string fileNameSuffix = fileNamePattern.substr(placeholderIdx + g_latest_version_placeholder.size());
+
+    const std::shared_ptr<const DirectoryIndex::Listing> listing = DirectoryIndex::GetInstance().GetListing(TfNormPath(dirPath));
+    _LatestVersion latestVersionEntry;
+    if (_latestVersions.Find(filePathPattern, &latestVersionEntry) && latestVersionEntry.listing == listing) {
+        return latestVersionEntry.filePath;
+    }
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("DirectoryListingCache::FindLatestVersion('%s') - Scanning directory '%s'\n",
+                                                  filePathPattern.c_str(), dirPath.c_str());
+    // The listing is sorted, so all candidates are a contiguous range.
+    std::string latestVersion;
+    const std::string* latestFileName = nullptr;
+    for (auto it = std::lower_bound(listing->fileNames.begin(), listing->fileNames.end(), fileNamePrefix);
+         it != listing->fileNames.end() && TfStringStartsWith(*it, fileNamePrefix); ++it) {
+        const std::string& fileName = *it;
+        if (fileName.size() <= fileNamePrefix.size() + fileNameSuffix.size() || !TfStringEndsWith(fileName, fileNameSuffix)) {
+            continue;
+        }
+        const size_t versionEnd = fileName.size() - fileNameSuffix.size();
+        if (!_IsDigits(fileName, fileNamePrefix.size(), versionEnd)) {
+            continue;
+        }
+        const std::string version = fileName.substr(fileNamePrefix.size(), versionEnd - fileNamePrefix.size());
+        if (!latestFileName || _CompareVersions(version, latestVersion) > 0) {
+            latestVersion = version;
+            latestFileName = &fileName;
+        }
+    }
+    latestVersionEntry.listing = listing;
+    latestVersionEntry.filePath = latestFileName ? TfStringCatPaths(dirPath, *latestFileName) : std::string();
+    _latestVersions.InsertOrAssign(filePathPattern, latestVersionEntry);
+    return latestVersionEntry.filePath;
+}
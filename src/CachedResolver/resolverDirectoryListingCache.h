@@ -0,0 +1,51 @@
+#ifndef AR_CACHEDRESOLVER_RESOLVER_DIRECTORY_LISTING_CACHE_H
+#define AR_CACHEDRESOLVER_RESOLVER_DIRECTORY_LISTING_CACHE_H
+
+#include "api.h"
+
+#include "concurrent_string_map.h"
+#include "directory_index.h"
+
+#include <memory>
+#include <string>
+
+/* Directory Listing Cache
+Backs the "latest version" lookups of the resolver contexts, so that resolving the
+latest version of thousands of assets doesn't cost a directory read (in Python) per asset.
+The directory listings come from the process wide DirectoryIndex, which re-reads a listing once
+the directory modification time changed (or the listing was read in the same second the directory
+last changed). The modification time is only re-checked if the last check is older than the stat
+interval (in seconds), set via the AR_CACHEDRESOLVER_DIRECTORY_LISTING_STAT_INTERVAL env var (defaults to 1).
+The latest version per file path pattern is memoized until its directory gets re-read.
+*/
+class CachedResolverDirectoryListingCache
+{
+public:
+    AR_CACHEDRESOLVER_API
+    static CachedResolverDirectoryListingCache& Get();
+
+    /* Returns the file path with the highest version that matches the file path pattern,
+    where the file name (not the directory) contains a {latest} placeholder for the version digits,
+    for example "/project/assets/assetA/assetA_v{latest}.usd". Returns an empty string if no file matches.
+    */
+    AR_CACHEDRESOLVER_API
+    std::string FindLatestVersion(const std::string& filePathPattern);
+    AR_CACHEDRESOLVER_API
+    void SetStatInterval(double statInterval);
+    AR_CACHEDRESOLVER_API
+    void Clear();
+
+private:
+    struct _LatestVersion
+    {
+        // The listing the file path was found in, a re-read listing invalidates the result.
+        std::shared_ptr<const DirectoryIndex::Listing> listing;
+        std::string filePath;
+    };
+
+    CachedResolverDirectoryListingCache();
+
+    ConcurrentStringMap<_LatestVersion> _latestVersions;
+};
+
+#endif // AR_CACHEDRESOLVER_RESOLVER_DIRECTORY_LISTING_CACHE_H
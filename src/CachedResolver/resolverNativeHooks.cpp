@@ -0,0 +1,186 @@
+#define CONVERT_STRING(string) #string
+#define DEFINE_STRING(string) CONVERT_STRING(string)
+
+#include "resolverNativeHooks.h"
+#include "resolver.h"
+#include "resolverContext.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/library.h"
+#include "pxr/base/tf/getenv.h"
+
+#include <iostream>
+#include <memory>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+/*
+The opaque handles are the (const) resolver/context pointers. As with the Python hooks,
+we circumvent the 'const' resolve calls here, see CachedResolverContext::ResolveAndCachePair.
+*/
+static CachedResolverContext*
+_GetContext(CachedResolverNativeContext* ctx)
+{
+    return reinterpret_cast<CachedResolverContext*>(ctx);
+}
+
+static const CachedResolverContext*
+_GetContext(const CachedResolverNativeContext* ctx)
+{
+    return reinterpret_cast<const CachedResolverContext*>(ctx);
+}
+
+static CachedResolverNativeContext*
+_GetNativeContext(const CachedResolverContext* ctx)
+{
+    return reinterpret_cast<CachedResolverNativeContext*>(const_cast<CachedResolverContext*>(ctx));
+}
+
+static void
+_SetResult(CachedResolverNativeResult* result, const char* str)
+{
+    if (result) {
+        *reinterpret_cast<std::string*>(result) = str ? str : "";
+    }
+}
+
+static const char*
+_GetMappingFilePath(const CachedResolverNativeContext* ctx)
+{
+    return _GetContext(ctx)->GetMappingFilePath().c_str();
+}
+
+static void
+_AddMappingPair(CachedResolverNativeContext* ctx, const char* sourceStr, const char* targetStr)
+{
+    _GetContext(ctx)->AddMappingPair(sourceStr, targetStr);
+}
+
+static void
+_RemoveMappingByKey(CachedResolverNativeContext* ctx, const char* sourceStr)
+{
+    _GetContext(ctx)->RemoveMappingByKey(sourceStr);
+}
+
+static void
+_AddPrefixMappingPair(CachedResolverNativeContext* ctx, const char* sourcePrefixStr, const char* targetPrefixStr)
+{
+    _GetContext(ctx)->AddPrefixMappingPair(sourcePrefixStr, targetPrefixStr);
+}
+
+static void
+_AddCachingPair(CachedResolverNativeContext* ctx, const char* sourceStr, const char* targetStr)
+{
+    _GetContext(ctx)->AddCachingPair(sourceStr, targetStr);
+}
+
+static void
+_RemoveCachingByKey(CachedResolverNativeContext* ctx, const char* sourceStr)
+{
+    _GetContext(ctx)->RemoveCachingByKey(sourceStr);
+}
+
+static int
+_ResolveLatestVersion(const CachedResolverNativeContext* ctx, const char* filePathPattern, CachedResolverNativeResult* result)
+{
+    const std::string latestFilePath = _GetContext(ctx)->ResolveLatestVersion(filePathPattern);
+    _SetResult(result, latestFilePath.c_str());
+    return !latestFilePath.empty();
+}
+
+static void
+_AddCachedRelativePathIdentifierPair(CachedResolverNativeResolver* resolver, const char* sourceStr, const char* targetStr)
+{
+    reinterpret_cast<CachedResolver*>(resolver)->AddCachedRelativePathIdentifierPair(sourceStr, targetStr);
+}
+
+const CachedResolverNativeHooks*
+CachedResolverNativeHooks::Get()
+{
+    static std::unique_ptr<CachedResolverNativeHooks> instance = [](){
+        std::unique_ptr<CachedResolverNativeHooks> hooks;
+        const std::string libraryPath = TfGetenv(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_NATIVE_HOOKS));
+        if (libraryPath.empty()) {
+            return hooks;
+        }
+        hooks.reset(new CachedResolverNativeHooks());
+        if (!hooks->_Load(libraryPath)) {
+            std::cerr << "Failed to load the native hook library '" << libraryPath << "', ";
+            std::cerr << "falling back to the Python hooks." << std::endl;
+            hooks.reset();
+        }
+        return hooks;
+    }();
+    return instance.get();
+}
+
+bool
+CachedResolverNativeHooks::_Load(const std::string& libraryPath)
+{
+    void* library = ArchLibraryOpen(libraryPath, ARCH_LIBRARY_NOW | ARCH_LIBRARY_LOCAL);
+    if (!library) {
+        std::cerr << ArchLibraryError() << std::endl;
+        return false;
+    }
+    auto getApiVersionFn = reinterpret_cast<CachedResolverNativeHooksGetApiVersionFn>(
+        ArchLibraryGetSymbolAddress(library, CACHEDRESOLVER_NATIVE_HOOKS_GET_API_VERSION_SYMBOL));
+    if (!getApiVersionFn || getApiVersionFn() != CACHEDRESOLVER_NATIVE_HOOKS_API_VERSION) {
+        std::cerr << "The native hook library has to export " << CACHEDRESOLVER_NATIVE_HOOKS_GET_API_VERSION_SYMBOL;
+        std::cerr << " returning API version " << CACHEDRESOLVER_NATIVE_HOOKS_API_VERSION << "." << std::endl;
+        ArchLibraryClose(library);
+        return false;
+    }
+    _initializeFn = reinterpret_cast<CachedResolverNativeHooksInitializeFn>(
+        ArchLibraryGetSymbolAddress(library, CACHEDRESOLVER_NATIVE_HOOKS_INITIALIZE_SYMBOL));
+    _resolveAndCacheFn = reinterpret_cast<CachedResolverNativeHooksResolveAndCacheFn>(
+        ArchLibraryGetSymbolAddress(library, CACHEDRESOLVER_NATIVE_HOOKS_RESOLVE_AND_CACHE_SYMBOL));
+    _createRelativePathIdentifierFn = reinterpret_cast<CachedResolverNativeHooksCreateRelativePathIdentifierFn>(
+        ArchLibraryGetSymbolAddress(library, CACHEDRESOLVER_NATIVE_HOOKS_CREATE_RELATIVE_PATH_IDENTIFIER_SYMBOL));
+
+    _hostApi.apiVersion = CACHEDRESOLVER_NATIVE_HOOKS_API_VERSION;
+    _hostApi.setResult = _SetResult;
+    _hostApi.getMappingFilePath = _GetMappingFilePath;
+    _hostApi.addMappingPair = _AddMappingPair;
+    _hostApi.removeMappingByKey = _RemoveMappingByKey;
+    _hostApi.addPrefixMappingPair = _AddPrefixMappingPair;
+    _hostApi.addCachingPair = _AddCachingPair;
+    _hostApi.removeCachingByKey = _RemoveCachingByKey;
+    _hostApi.resolveLatestVersion = _ResolveLatestVersion;
+    _hostApi.addCachedRelativePathIdentifierPair = _AddCachedRelativePathIdentifierPair;
+    // The library is intentionally never closed, hooks can be called until process exit.
+    return true;
+}
+
+bool
+CachedResolverNativeHooks::Initialize(const CachedResolverContext* ctx) const
+{
+    if (!_initializeFn) {
+        return false;
+    }
+    return _initializeFn(&_hostApi, _GetNativeContext(ctx)) != 0;
+}
+
+bool
+CachedResolverNativeHooks::ResolveAndCache(const CachedResolverContext* ctx, const std::string& assetPath, std::string* result) const
+{
+    if (!_resolveAndCacheFn) {
+        return false;
+    }
+    return _resolveAndCacheFn(&_hostApi, _GetNativeContext(ctx), assetPath.c_str(),
+                              reinterpret_cast<CachedResolverNativeResult*>(result)) != 0;
+}
+
+bool
+CachedResolverNativeHooks::CreateRelativePathIdentifier(const CachedResolver* resolver,
+                                                        const std::string& anchoredAssetPath,
+                                                        const std::string& assetPath,
+                                                        const std::string& anchorAssetPath,
+                                                        std::string* result) const
+{
+    if (!_createRelativePathIdentifierFn) {
+        return false;
+    }
+    CachedResolverNativeResolver* nativeResolver = reinterpret_cast<CachedResolverNativeResolver*>(const_cast<CachedResolver*>(resolver));
+    return _createRelativePathIdentifierFn(&_hostApi, nativeResolver, anchoredAssetPath.c_str(), assetPath.c_str(),
+                                           anchorAssetPath.c_str(), reinterpret_cast<CachedResolverNativeResult*>(result)) != 0;
+}
@@ -0,0 +1,55 @@
+#ifndef AR_CACHEDRESOLVER_RESOLVER_NATIVE_HOOKS_H
+#define AR_CACHEDRESOLVER_RESOLVER_NATIVE_HOOKS_H
+
+#include "api.h"
+#include "nativeHooks.h"
+
+#include "pxr/pxr.h"
+
+#include <string>
+
+PXR_NAMESPACE_OPEN_SCOPE
+class CachedResolver;
+PXR_NAMESPACE_CLOSE_SCOPE
+class CachedResolverContext;
+
+/* Native Hooks
+Loads the native hook library set via the AR_CACHEDRESOLVER_NATIVE_HOOKS env var
+(see nativeHooks.h for the C ABI) and calls into it. This lets studios implement
+the resolve logic in C/C++/Rust, so that cache misses don't need the GIL and can be
+resolved in parallel. The library is loaded once per process and never unloaded.
+*/
+class CachedResolverNativeHooks
+{
+public:
+    // Returns nullptr if no native hook library is configured or it failed to load.
+    AR_CACHEDRESOLVER_API
+    static const CachedResolverNativeHooks* Get();
+
+    bool HasInitialize() const { return _initializeFn != nullptr; }
+    bool HasResolveAndCache() const { return _resolveAndCacheFn != nullptr; }
+    bool HasCreateRelativePathIdentifier() const { return _createRelativePathIdentifierFn != nullptr; }
+
+    AR_CACHEDRESOLVER_API
+    bool Initialize(const CachedResolverContext* ctx) const;
+    AR_CACHEDRESOLVER_API
+    bool ResolveAndCache(const CachedResolverContext* ctx, const std::string& assetPath, std::string* result) const;
+    AR_CACHEDRESOLVER_API
+    bool CreateRelativePathIdentifier(const PXR_NS::CachedResolver* resolver,
+                                      const std::string& anchoredAssetPath,
+                                      const std::string& assetPath,
+                                      const std::string& anchorAssetPath,
+                                      std::string* result) const;
+
+private:
+    CachedResolverNativeHooks() = default;
+
+    bool _Load(const std::string& libraryPath);
+
+    CachedResolverNativeHostApi _hostApi{};
+    CachedResolverNativeHooksInitializeFn _initializeFn{nullptr};
+    CachedResolverNativeHooksResolveAndCacheFn _resolveAndCacheFn{nullptr};
+    CachedResolverNativeHooksCreateRelativePathIdentifierFn _createRelativePathIdentifierFn{nullptr};
+};
+
+#endif // AR_CACHEDRESOLVER_RESOLVER_NATIVE_HOOKS_H
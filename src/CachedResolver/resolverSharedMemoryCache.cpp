@@ -0,0 +1,355 @@
+#define CONVERT_STRING(string) #string
+#define DEFINE_STRING(string) CONVERT_STRING(string)
+
+#include "resolverSharedMemoryCache.h"
+#include "debugCodes.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/defines.h"
+#include "pxr/base/tf/debug.h"
+#include "pxr/base/tf/getenv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#if !defined(ARCH_OS_WINDOWS)
+#include <cerrno>
+#include <fcntl.h>
+#include <grp.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+static const uint64_t g_shared_memory_cache_magic = 0x4152434143484531ULL; // "ARCACHE1"
+static const uint64_t g_shared_memory_cache_version = 2;
+static const uint64_t g_slot_state_empty = 0;
+static const uint64_t g_slot_state_claimed = 1;
+
+static uint64_t
+_GetKeyHash(const std::string& contextKey, const std::string& assetPath)
+{
+    // This has to be stable across processes, so we don't use std::hash/TfHash here.
+    uint64_t hash = 14695981039346656037ULL;
+    auto hashBytes = [&hash](const char* data, size_t size){
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+    hashBytes(contextKey.data(), contextKey.size());
+    hashBytes("\0", 1);
+    hashBytes(assetPath.data(), assetPath.size());
+    // The empty/claimed slot states are reserved.
+    return hash < 2 ? hash + 2 : hash;
+}
+
+CachedResolverSharedMemoryCache*
+CachedResolverSharedMemoryCache::Get()
+{
+    static std::unique_ptr<CachedResolverSharedMemoryCache> instance = [](){
+        std::unique_ptr<CachedResolverSharedMemoryCache> cache;
+        const std::string segmentName = TfGetenv(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_SHARED_MEMORY_CACHE));
+        if (segmentName.empty()) {
+            return cache;
+        }
+        const int segmentSizeMB = TfGetenvInt(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_SHARED_MEMORY_CACHE_SIZE), 64);
+        cache.reset(new CachedResolverSharedMemoryCache());
+        if (!cache->_Open(segmentName, static_cast<size_t>(std::max(segmentSizeMB, 1)) * 1024 * 1024)) {
+            std::cerr << "Failed to open the shared memory cache segment '" << segmentName << "', ";
+            std::cerr << "falling back to process local caching." << std::endl;
+            cache.reset();
+        }
+        return cache;
+    }();
+    return instance.get();
+}
+
+#if defined(ARCH_OS_WINDOWS)
+
+CachedResolverSharedMemoryCache::~CachedResolverSharedMemoryCache() = default;
+
+bool
+CachedResolverSharedMemoryCache::_Open(const std::string& segmentName, size_t segmentSize)
+{
+    // Not supported (yet).
+    return false;
+}
+
+#else
+
+CachedResolverSharedMemoryCache::~CachedResolverSharedMemoryCache()
+{
+    if (_mapping) {
+        munmap(_mapping, _mappingSize);
+    }
+}
+
+static bool
+_GetSegmentGroup(bool* hasGroup, gid_t* groupId)
+{
+    const std::string groupName = TfGetenv(DEFINE_STRING(AR_CACHEDRESOLVER_ENV_SHARED_MEMORY_CACHE_GROUP));
+    *hasGroup = !groupName.empty();
+    if (!*hasGroup) {
+        return true;
+    }
+    const struct group* groupEntry = getgrnam(groupName.c_str());
+    if (!groupEntry) {
+        std::cerr << "The shared memory cache group '" << groupName << "' doesn't exist." << std::endl;
+        return false;
+    }
+    *groupId = groupEntry->gr_gid;
+    return true;
+}
+
+static bool
+_IsTrustedSegment(int fd, bool hasGroup, gid_t groupId)
+{
+    // Other processes serve the segment's resolve results without checking them, so only
+    // segments that can't be written by users outside of the owner (or the configured group) are trusted.
+    struct stat fdStat{};
+    if (fstat(fd, &fdStat) != 0 || (fdStat.st_mode & S_IWOTH)) {
+        return false;
+    }
+    if (fdStat.st_uid == geteuid()) {
+        return true;
+    }
+    return hasGroup && fdStat.st_gid == groupId;
+}
+
+static void
+_UnlinkStaleSegment(const std::string& name, int fd)
+{
+    // Only unlink the segment if the name still refers to it, another process might have replaced it already.
+    struct stat fdStat{}, nameStat{};
+    const int nameFd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (nameFd < 0) {
+        return;
+    }
+    if (fstat(fd, &fdStat) == 0 && fstat(nameFd, &nameStat) == 0 &&
+        fdStat.st_dev == nameStat.st_dev && fdStat.st_ino == nameStat.st_ino) {
+        shm_unlink(name.c_str());
+    }
+    close(nameFd);
+}
+
+bool
+CachedResolverSharedMemoryCache::_Open(const std::string& segmentName, size_t segmentSize)
+{
+    const std::string name = segmentName[0] == '/' ? segmentName : "/" + segmentName;
+    bool hasGroup = false;
+    gid_t groupId = 0;
+    if (!_GetSegmentGroup(&hasGroup, &groupId)) {
+        return false;
+    }
+    // A segment whose creator died before initializing it gets replaced once.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        const _OpenResult result = this->_OpenSegment(name, segmentSize, hasGroup, groupId);
+        if (result != _OpenResult::Stale) {
+            return result == _OpenResult::Opened;
+        }
+    }
+    return false;
+}
+
+CachedResolverSharedMemoryCache::_OpenResult
+CachedResolverSharedMemoryCache::_OpenSegment(const std::string& name, size_t segmentSize, bool hasGroup, gid_t groupId)
+{
+    // The first process creates and initializes the segment while holding an exclusive lock,
+    // all others wait on the lock until it got initialized. If the creator crashes, the lock
+    // gets released by the kernel and the uninitialized segment is detected as stale.
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    const bool isCreator = fd >= 0;
+    if (isCreator) {
+        flock(fd, LOCK_EX);
+        // The creation mode is masked by the umask, so the group permissions are set explicitly.
+        if ((hasGroup && (fchown(fd, static_cast<uid_t>(-1), groupId) != 0 || fchmod(fd, 0660) != 0)) ||
+            ftruncate(fd, static_cast<off_t>(segmentSize)) != 0) {
+            shm_unlink(name.c_str());
+            close(fd);
+            return _OpenResult::Failed;
+        }
+    } else {
+        if (errno != EEXIST) {
+            return _OpenResult::Failed;
+        }
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return _OpenResult::Failed;
+        }
+        if (!_IsTrustedSegment(fd, hasGroup, groupId)) {
+            std::cerr << "The shared memory cache segment '" << name << "' is writable by untrusted users, ";
+            std::cerr << "it has to be owned by the current user (or the configured group)." << std::endl;
+            close(fd);
+            return _OpenResult::Failed;
+        }
+    }
+    void* mapping = MAP_FAILED;
+    if (isCreator) {
+        mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    } else {
+        // Platforms without flock support on shared memory (the lock calls fail) fall back to polling.
+        const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (true) {
+            flock(fd, LOCK_SH);
+            struct stat fdStat{};
+            if (fstat(fd, &fdStat) == 0 && static_cast<size_t>(fdStat.st_size) >= sizeof(_Header)) {
+                segmentSize = static_cast<size_t>(fdStat.st_size);
+                mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (mapping != MAP_FAILED &&
+                    static_cast<_Header*>(mapping)->magic.load(std::memory_order_acquire) == g_shared_memory_cache_magic) {
+                    break;
+                }
+                if (mapping != MAP_FAILED) {
+                    munmap(mapping, segmentSize);
+                    mapping = MAP_FAILED;
+                }
+            }
+            flock(fd, LOCK_UN);
+            if (std::chrono::steady_clock::now() > timeout) {
+                TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("SharedMemoryCache::_Open('%s') - Replacing stale segment\n", name.c_str());
+                _UnlinkStaleSegment(name, fd);
+                close(fd);
+                return _OpenResult::Stale;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if (mapping == MAP_FAILED) {
+        if (isCreator) {
+            shm_unlink(name.c_str());
+        }
+        close(fd);
+        return _OpenResult::Failed;
+    }
+    _mapping = mapping;
+    _mappingSize = segmentSize;
+    _header = static_cast<_Header*>(mapping);
+
+    if (isCreator) {
+        // The segment is zero initialized, so all slots start out empty.
+        // We use 1/8 of the segment for the (power of 2 sized) slot table.
+        uint64_t slotCount = 1;
+        while (slotCount * 2 * sizeof(_Slot) <= segmentSize / 8) {
+            slotCount *= 2;
+        }
+        _header->version = g_shared_memory_cache_version;
+        _header->slotCount = slotCount;
+        _header->heapOffset = sizeof(_Header) + slotCount * sizeof(_Slot);
+        _header->heapSize = segmentSize - _header->heapOffset;
+        _header->heapUsed.store(0, std::memory_order_relaxed);
+        _header->magic.store(g_shared_memory_cache_magic, std::memory_order_release);
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+    if (!isCreator &&
+        (_header->version != g_shared_memory_cache_version ||
+         _header->slotCount == 0 ||
+         (_header->slotCount & (_header->slotCount - 1)) != 0 ||
+         _header->heapOffset != sizeof(_Header) + _header->slotCount * sizeof(_Slot) ||
+         _header->heapOffset + _header->heapSize != segmentSize)) {
+        munmap(_mapping, _mappingSize);
+        _mapping = nullptr;
+        _header = nullptr;
+        return _OpenResult::Failed;
+    }
+    _slots = reinterpret_cast<_Slot*>(static_cast<char*>(mapping) + sizeof(_Header));
+    _heap = static_cast<char*>(mapping) + _header->heapOffset;
+    TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("SharedMemoryCache::_Open('%s') - %s segment with %zu slots\n",
+                                                  name.c_str(), isCreator ? "Created" : "Attached to",
+                                                  static_cast<size_t>(_header->slotCount));
+    return _OpenResult::Opened;
+}
+
+#endif
+
+const CachedResolverSharedMemoryCache::_Slot*
+CachedResolverSharedMemoryCache::_FindSlot(
+    uint64_t hash,
+    const std::string& contextKey,
+    const std::string& assetPath) const
+{
+    const uint64_t slotMask = _header->slotCount - 1;
+    const size_t keySize = contextKey.size() + 1 + assetPath.size();
+    for (uint64_t probe = 0, index = hash & slotMask; probe <= slotMask; probe++, index = (index + 1) & slotMask) {
+        const _Slot& slot = _slots[index];
+        const uint64_t state = slot.state.load(std::memory_order_acquire);
+        if (state == g_slot_state_empty) {
+            return nullptr;
+        }
+        // Claimed slots are still being written, so we skip them.
+        if (state != hash || slot.keySize != keySize) {
+            continue;
+        }
+        if (slot.heapOffset + slot.keySize + slot.valueSize > _header->heapSize) {
+            continue;
+        }
+        const char* key = _heap + slot.heapOffset;
+        if (std::memcmp(key, contextKey.data(), contextKey.size()) == 0 &&
+            key[contextKey.size()] == '\0' &&
+            std::memcmp(key + contextKey.size() + 1, assetPath.data(), assetPath.size()) == 0) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+bool
+CachedResolverSharedMemoryCache::Find(
+    const std::string& contextKey,
+    const std::string& assetPath,
+    std::string* value) const
+{
+    const _Slot* slot = this->_FindSlot(_GetKeyHash(contextKey, assetPath), contextKey, assetPath);
+    if (!slot) {
+        return false;
+    }
+    value->assign(_heap + slot->heapOffset + slot->keySize, slot->valueSize);
+    return true;
+}
+
+bool
+CachedResolverSharedMemoryCache::Insert(
+    const std::string& contextKey,
+    const std::string& assetPath,
+    const std::string& value)
+{
+    const uint64_t hash = _GetKeyHash(contextKey, assetPath);
+    if (this->_FindSlot(hash, contextKey, assetPath)) {
+        return true;
+    }
+    // Allocate and write the key/value bytes before publishing the slot.
+    const size_t keySize = contextKey.size() + 1 + assetPath.size();
+    const size_t dataSize = keySize + value.size();
+    const uint64_t heapOffset = _header->heapUsed.fetch_add(dataSize, std::memory_order_relaxed);
+    if (heapOffset + dataSize > _header->heapSize) {
+        TF_DEBUG(CACHEDRESOLVER_RESOLVER_CONTEXT).Msg("SharedMemoryCache::Insert('%s') - Segment is full\n", assetPath.c_str());
+        return false;
+    }
+    char* data = _heap + heapOffset;
+    std::memcpy(data, contextKey.data(), contextKey.size());
+    data[contextKey.size()] = '\0';
+    std::memcpy(data + contextKey.size() + 1, assetPath.data(), assetPath.size());
+    std::memcpy(data + keySize, value.data(), value.size());
+    const uint64_t slotMask = _header->slotCount - 1;
+    for (uint64_t probe = 0, index = hash & slotMask; probe <= slotMask; probe++, index = (index + 1) & slotMask) {
+        _Slot& slot = _slots[index];
+        uint64_t state = g_slot_state_empty;
+        if (!slot.state.compare_exchange_strong(state, g_slot_state_claimed, std::memory_order_acquire)) {
+            continue;
+        }
+        slot.heapOffset = heapOffset;
+        slot.keySize = static_cast<uint32_t>(keySize);
+        slot.valueSize = static_cast<uint32_t>(value.size());
+        slot.state.store(hash, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
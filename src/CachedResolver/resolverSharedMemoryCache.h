@@ -0,0 +1,97 @@
+#ifndef AR_CACHEDRESOLVER_RESOLVER_SHARED_MEMORY_CACHE_H
+#define AR_CACHEDRESOLVER_RESOLVER_SHARED_MEMORY_CACHE_H
+
+#include "api.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/defines.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if !defined(ARCH_OS_WINDOWS)
+#include <sys/types.h>
+#endif
+
+/* Shared Memory Cache
+An opt-in, node local cache of resolved caching pairs that is shared by all processes
+(e.g. multiple husk/hython processes rendering the same shot) via a POSIX shared memory segment.
+It is enabled by setting the AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE env var to the segment name.
+
+The segment holds an append-only open addressing hash table keyed by (context key, asset path)
+and a heap for the key/value bytes. Readers never lock, writers allocate their bytes from the heap
+via an atomic bump pointer and then claim an empty slot via compare and swap (one writer per slot).
+A slot only gets published (by storing its hash) after its data was written.
+Entries are never removed, once the heap or the slots are exhausted, inserts are skipped.
+The segment stays alive until it is removed (e.g. via 'rm /dev/shm/<name>') or the node reboots.
+The context key holds the mapping file path, modification time and size, so that contexts of a
+changed mapping file don't get served results that were cached for its previous content.
+
+The segment is only accessible by the creating user (or by the group set via the
+AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE_GROUP env var), segments that other users can write to are rejected.
+Segments whose creator died before initializing them are detected via the (kernel released)
+creation lock and get replaced.
+*/
+class CachedResolverSharedMemoryCache
+{
+public:
+    // Returns nullptr if the shared memory cache is disabled or not supported on this platform.
+    AR_CACHEDRESOLVER_API
+    static CachedResolverSharedMemoryCache* Get();
+
+    AR_CACHEDRESOLVER_API
+    ~CachedResolverSharedMemoryCache();
+
+    AR_CACHEDRESOLVER_API
+    bool Find(const std::string& contextKey, const std::string& assetPath, std::string* value) const;
+    AR_CACHEDRESOLVER_API
+    bool Insert(const std::string& contextKey, const std::string& assetPath, const std::string& value);
+
+private:
+    struct _Header
+    {
+        std::atomic<uint64_t> magic;
+        uint64_t version;
+        uint64_t slotCount;
+        uint64_t heapOffset;
+        uint64_t heapSize;
+        std::atomic<uint64_t> heapUsed;
+    };
+
+    struct _Slot
+    {
+        // 0 = empty, 1 = claimed by a writer, otherwise the (published) key hash
+        std::atomic<uint64_t> state;
+        uint64_t heapOffset;
+        uint32_t keySize;
+        uint32_t valueSize;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "The shared memory cache requires lock free 64 bit atomics.");
+
+    CachedResolverSharedMemoryCache() = default;
+
+    enum class _OpenResult
+    {
+        Opened,
+        Failed,
+        Stale
+    };
+
+    bool _Open(const std::string& segmentName, size_t segmentSize);
+#if !defined(ARCH_OS_WINDOWS)
+    _OpenResult _OpenSegment(const std::string& name, size_t segmentSize, bool hasGroup, gid_t groupId);
+#endif
+    const _Slot* _FindSlot(uint64_t hash, const std::string& contextKey, const std::string& assetPath) const;
+
+    void* _mapping{nullptr};
+    size_t _mappingSize{0};
+    _Header* _header{nullptr};
+    _Slot* _slots{nullptr};
+    char* _heap{nullptr};
+};
+
+#endif // AR_CACHEDRESOLVER_RESOLVER_SHARED_MEMORY_CACHE_H
@@ -4,8 +4,16 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 CachedResolverTokensType::CachedResolverTokensType() :
     mappingPairs("mappingPairs", TfToken::Immortal),
+    cachingPairs("cachingPairs", TfToken::Immortal),
+    prefixMappingPairs("prefixMappingPairs", TfToken::Immortal),
+    identifierTemplates("identifierTemplates", TfToken::Immortal),
+    resolveRules("resolveRules", TfToken::Immortal),
     allTokens({
-        mappingPairs
+        mappingPairs,
+        cachingPairs,
+        prefixMappingPairs,
+        identifierTemplates,
+        resolveRules
     })
 {
 }
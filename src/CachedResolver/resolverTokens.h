@@ -15,6 +15,10 @@ struct CachedResolverTokensType
     AR_CACHEDRESOLVER_API CachedResolverTokensType();
 
     const TfToken mappingPairs;
+    const TfToken cachingPairs;
+    const TfToken prefixMappingPairs;
+    const TfToken identifierTemplates;
+    const TfToken resolveRules;
     const std::vector<TfToken> allTokens;
 };
 
@@ -0,0 +1,49 @@
+"""Benchmark the mapping file load time of the CachedResolver context against the mapping pair count.
+This isn't picked up by the unit tests (unittest discover only runs test*.py files), run it manually via:
+> python benchmarkMappingFileLoad.py --pair-counts 1000 10000 100000 500000
+"""
+from __future__ import print_function
+import argparse
+import os
+import tempfile
+import time
+
+from pxr import Sdf, Vt
+from usdAssetResolver import CachedResolver
+
+
+def create_mapping_file(file_path, pair_count):
+    mapping_pairs = []
+    for idx in range(pair_count):
+        mapping_pairs.append("assets/asset{idx}/asset{idx}.usd".format(idx=idx))
+        mapping_pairs.append("/project/assets/asset{idx}/asset{idx}_v001.usd".format(idx=idx))
+    layer = Sdf.Layer.CreateAnonymous()
+    layer.customLayerData = {CachedResolver.Tokens.mappingPairs: Vt.StringArray(mapping_pairs)}
+    layer.Export(file_path)
+
+
+def benchmark(pair_counts, repeat, file_format):
+    # Snapshots would skip the mapping file load.
+    os.environ.pop("AR_CACHEDRESOLVER_SNAPSHOT_DIR", None)
+    print("{:>12} {:>12} {:>12}".format("pairs", "load (ms)", "per pair (us)"))
+    with tempfile.TemporaryDirectory() as temp_dir_path:
+        for pair_count in pair_counts:
+            mapping_file_path = os.path.join(temp_dir_path, "mapping_{}.{}".format(pair_count, file_format))
+            create_mapping_file(mapping_file_path, pair_count)
+            durations = []
+            for _ in range(repeat):
+                start_time = time.perf_counter()
+                ctx = CachedResolver.ResolverContext(mapping_file_path)
+                durations.append(time.perf_counter() - start_time)
+                assert len(ctx.GetMappingPairs()) == pair_count
+            duration = min(durations)
+            print("{:>12} {:>12.2f} {:>12.3f}".format(pair_count, duration * 1000.0, duration / max(pair_count, 1) * 1000000.0))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--pair-counts", type=int, nargs="+", default=[1000, 10000, 100000, 500000])
+    parser.add_argument("--repeat", type=int, default=3, help="The best of n runs gets reported.")
+    parser.add_argument("--file-format", choices=["usda", "usdc"], default="usdc")
+    args = parser.parse_args()
+    benchmark(args.pair_counts, args.repeat, args.file_format)
@@ -1,9 +1,12 @@
 from __future__ import print_function
 import tempfile
 import os
+import subprocess
+import sys
+import time
 import unittest
 
-from pxr import Ar, Sdf, Usd, Vt
+from pxr import Ar, Sdf, Tf, Usd, Vt
 from usdAssetResolver import CachedResolver
 
 import PythonExpose
@@ -210,6 +213,59 @@ class TestArResolver(unittest.TestCase):
 
         cached_resolver.SetExposeRelativePathIdentifierState(False)
 
+    def test_CreateRelativeIdentifierWithIdentifierTemplates(self):
+        resolver = Ar.GetResolver()
+        cached_resolver = Ar.GetUnderlyingResolver()
+        cached_resolver.SetExposeRelativePathIdentifierState(True)
+        PythonExpose.UnitTestHelper.reset()
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create mapping file
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usda")
+            mapping_layer = Sdf.Layer.CreateAnonymous()
+            mapping_layer.customLayerData = {
+                CachedResolver.Tokens.identifierTemplates: Vt.StringArray(
+                    [r".*/assets/(\w+)/(\w+)_v\d+\.usd", "assets/$1/$2.usd",
+                     r".*/shots/(\w+)/.*", "shots/$1/shot.usd"]
+                )
+            }
+            mapping_layer.Export(mapping_file_path)
+            ctx = CachedResolver.ResolverContext(mapping_file_path)
+            self.assertEqual(
+                ctx.GetIdentifierTemplates(),
+                [(r".*/assets/(\w+)/(\w+)_v\d+\.usd", "assets/$1/$2.usd"),
+                 (r".*/shots/(\w+)/.*", "shots/$1/shot.usd")],
+            )
+            # Invalid regex expressions are skipped
+            self.assertEqual(ctx.AddIdentifierTemplate("(unbalanced", "invalid"), False)
+            self.assertEqual(len(ctx.GetIdentifierTemplates()), 2)
+            with Ar.ResolverContextBinder(ctx):
+                # Template matches don't call into Python
+                self.assertEqual(
+                    resolver.CreateIdentifier("../assetA/assetA_v002.usd", Ar.ResolvedPath("/project/assets/assetB/assetB.usd")),
+                    "assets/assetA/assetA.usd",
+                )
+                self.assertEqual(
+                    resolver.CreateIdentifier("./layout.usd", Ar.ResolvedPath("/project/shots/sh010/shot.usd")),
+                    "shots/sh010/shot.usd",
+                )
+                self.assertEqual(PythonExpose.UnitTestHelper.create_relative_path_identifier_call_counter, 0)
+                # Everything else still goes through Python
+                self.assertEqual(
+                    resolver.CreateIdentifier("./some/relative/path.usd", Ar.ResolvedPath("/some/absolute/path.usd")),
+                    "relativePath|./some/relative/path.usd?/some/absolute/path.usd",
+                )
+                self.assertEqual(PythonExpose.UnitTestHelper.create_relative_path_identifier_call_counter, 1)
+                # Clear
+                ctx.ClearIdentifierTemplates()
+                self.assertEqual(ctx.GetIdentifierTemplates(), [])
+                self.assertEqual(
+                    resolver.CreateIdentifier("./layout.usd", Ar.ResolvedPath("/project/shots/sh010/shot.usd")),
+                    "relativePath|./layout.usd?/project/shots/sh010/shot.usd",
+                )
+                self.assertEqual(PythonExpose.UnitTestHelper.create_relative_path_identifier_call_counter, 2)
+        cached_resolver.ClearCachedRelativePathIdentifierPairs()
+        cached_resolver.SetExposeRelativePathIdentifierState(False)
+
     def test_CreateIdentifierForNewAsset(self):
         resolver = Ar.GetResolver()
 
@@ -410,22 +466,79 @@ class TestArResolver(unittest.TestCase):
             ctx.AddCachingPair(layer_identifier, layer_file_path)
             # Get resolver
             resolver = Ar.GetResolver()
-            with Ar.ResolverContextBinder(ctx):
-                with Ar.ResolverScopedCache():
-                    # Resolve
-                    self.assertEqual(
-                        os.path.abspath(layer_file_path),
-                        resolver.Resolve(layer_identifier),
-                    )
+            # Validations are only kept for the lifetime of the scoped cache
+            resolver.SetRevalidationPolicy(CachedResolver.RevalidationPolicy.CacheScope)
+            try:
+                with Ar.ResolverContextBinder(ctx):
+                    with Ar.ResolverScopedCache():
+                        resolver.ResetStatistics()
+                        # Resolve
+                        self.assertEqual(
+                            os.path.abspath(layer_file_path),
+                            resolver.Resolve(layer_identifier),
+                        )
+                        call_count = resolver.GetStatistics()["statCallCount"]
+                        # Remove file
+                        os.remove(layer_file_path)
+                        # Query cached result
+                        self.assertEqual(
+                            os.path.abspath(layer_file_path),
+                            resolver.Resolve(layer_identifier),
+                        )
+                        # Identifiers and modification timestamps are cached as well
+                        anchor_path = Ar.ResolvedPath(os.path.join(temp_dir_path, "anchor.usd"))
+                        identifier = resolver.CreateIdentifier("./other.usd", anchor_path)
+                        self.assertEqual(identifier, resolver.CreateIdentifier("./other.usd", anchor_path))
+                        for _ in range(2):
+                            resolver.GetModificationTimestamp(layer_identifier, Ar.ResolvedPath(layer_file_path))
+                        # Repeated calls in the scope don't hit the file system
+                        statistics = resolver.GetStatistics()
+                        self.assertEqual(statistics["scopedCacheHitCount"], 3)
+                        self.assertEqual(statistics["statCallCount"], call_count + 1)
+                    # Uncached result should now return empty result
+                    self.assertEqual("", resolver.Resolve(layer_identifier))
+            finally:
+                resolver.SetRevalidationPolicy(CachedResolver.RevalidationPolicy.TimeToLive)
+
+    def test_ResolveWithRevalidationPolicy(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = "layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Create context
+            ctx = CachedResolver.ResolverContext()
+            ctx.AddCachingPair(layer_identifier, layer_file_path)
+            prefix_mapped_identifier = "prefix/" + layer_identifier
+            ctx.AddPrefixMappingPair("prefix/", temp_dir_path + os.sep)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            self.assertEqual(resolver.GetRevalidationPolicy(), CachedResolver.RevalidationPolicy.TimeToLive)
+            try:
+                resolver.SetRevalidationPolicy(CachedResolver.RevalidationPolicy.Never)
+                with Ar.ResolverContextBinder(ctx):
+                    # Resolve (and validate on first hit)
+                    for identifier in [layer_identifier, prefix_mapped_identifier]:
+                        self.assertEqual(
+                            os.path.abspath(layer_file_path),
+                            resolver.Resolve(identifier),
+                        )
                     # Remove file
                     os.remove(layer_file_path)
-                    # Query cached result
-                    self.assertEqual(
-                        os.path.abspath(layer_file_path),
-                        resolver.Resolve(layer_identifier),
-                    )
-                # Uncached result should now return empty result
-                self.assertEqual("", resolver.Resolve(layer_identifier))
+                    # Validated entries (including prefix mapped ones) are not re-validated
+                    for identifier in [layer_identifier, prefix_mapped_identifier]:
+                        self.assertEqual(
+                            os.path.abspath(layer_file_path),
+                            resolver.Resolve(identifier),
+                        )
+                    # Expired validations trigger a re-validation
+                    resolver.SetRevalidationPolicy(CachedResolver.RevalidationPolicy.TimeToLive)
+                    resolver.SetRevalidationTTL(0.0)
+                    self.assertEqual("", resolver.Resolve(layer_identifier))
+                    self.assertEqual("", resolver.Resolve(prefix_mapped_identifier))
+            finally:
+                resolver.SetRevalidationPolicy(CachedResolver.RevalidationPolicy.TimeToLive)
+                resolver.SetRevalidationTTL(60.0)
 
     def test_ResolverCachingMechanism(self):
         with tempfile.TemporaryDirectory() as temp_dir_path:
@@ -497,6 +610,200 @@ class TestArResolver(unittest.TestCase):
                 self.assertEqual(ctx.GetMappingPairs(), {asset_a_identifier: asset_c_layer_file_path})
                 self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 2)
 
+    def test_ResolverBatchCachingMechanism(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Reset UnitTestHelper
+            PythonExpose.UnitTestHelper.reset(current_directory_path=temp_dir_path)
+            # Create files
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            layer = Sdf.Layer.CreateAnonymous()
+            layer.subLayerPaths.append("sublayerA.usd")
+            prim_spec = Sdf.CreatePrimInLayer(layer, "/prim")
+            prim_spec.referenceList.Prepend(Sdf.Reference("referenceA.usd"))
+            prim_spec.payloadList.Prepend(Sdf.Payload("payloadA.usd"))
+            prim_spec.referenceList.Prepend(Sdf.Reference("./fileRelative.usd"))
+            layer.Export(layer_file_path)
+            layer = Sdf.Layer.FindOrOpen(layer_file_path)
+            # Create context
+            ctx = CachedResolver.ResolverContext()
+            cached_resolver = Ar.GetUnderlyingResolver()
+            cached_resolver.SetBatchResolveLayerDependenciesState(True)
+            try:
+                resolver = Ar.GetResolver()
+                with Ar.ResolverContextBinder(ctx):
+                    resolver.CreateIdentifier("referenceA.usd", Ar.ResolvedPath(layer.realPath))
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_batch_call_counter, 1)
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 3)
+                    caching_pairs = ctx.GetCachingPairs()
+                    for identifier in ["sublayerA.usd", "referenceA.usd", "payloadA.usd"]:
+                        self.assertIn(identifier, caching_pairs)
+                    self.assertNotIn("./fileRelative.usd", caching_pairs)
+                    # The layer is only batched once and the results are served from the cache
+                    resolver.CreateIdentifier("payloadA.usd", Ar.ResolvedPath(layer.realPath))
+                    resolver.Resolve("sublayerA.usd")
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_batch_call_counter, 1)
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 3)
+            finally:
+                cached_resolver.SetBatchResolveLayerDependenciesState(False)
+
+    def test_ResolverBatchCachingMechanismWithResolveRules(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Reset UnitTestHelper
+            PythonExpose.UnitTestHelper.reset(current_directory_path=temp_dir_path)
+            # Create files
+            asset_a_layer_file_path = os.path.join(temp_dir_path, "assets", "assetA", "assetA_v001.usd")
+            os.makedirs(os.path.dirname(asset_a_layer_file_path))
+            Sdf.Layer.CreateAnonymous().Export(asset_a_layer_file_path)
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            layer = Sdf.Layer.CreateAnonymous()
+            prim_spec = Sdf.CreatePrimInLayer(layer, "/prim")
+            prim_spec.referenceList.Prepend(Sdf.Reference("assets/assetA.usd"))
+            prim_spec.referenceList.Prepend(Sdf.Reference("shots/shotA.usd"))
+            layer.Export(layer_file_path)
+            layer = Sdf.Layer.FindOrOpen(layer_file_path)
+            # Create context
+            ctx = CachedResolver.ResolverContext()
+            ctx.AddResolveRule(r"assets/(\w+)\.usd", os.path.join(temp_dir_path, "assets", "$1", "$1_v001.usd"))
+            cached_resolver = Ar.GetUnderlyingResolver()
+            cached_resolver.SetBatchResolveLayerDependenciesState(True)
+            try:
+                resolver = Ar.GetResolver()
+                with Ar.ResolverContextBinder(ctx):
+                    resolver.CreateIdentifier("shots/shotA.usd", Ar.ResolvedPath(layer.realPath))
+                    # Rule covered asset paths are not sent to the batch hook
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_batch_call_counter, 1)
+                    self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 1)
+                    caching_pairs = ctx.GetCachingPairs()
+                    self.assertEqual(caching_pairs["assets/assetA.usd"], asset_a_layer_file_path)
+                    self.assertEqual(caching_pairs["shots/shotA.usd"], "/some/path/to/a/file.usd")
+                    self.assertEqual(resolver.Resolve("assets/assetA.usd").GetPathString(), asset_a_layer_file_path)
+            finally:
+                cached_resolver.SetBatchResolveLayerDependenciesState(False)
+
+    def test_ResolverContextQueryStatistics(self):
+        # Reset UnitTestHelper
+        PythonExpose.UnitTestHelper.reset()
+        # Create context
+        ctx = CachedResolver.ResolverContext()
+        ctx.ResetQueryStatistics()
+        resolver = Ar.GetResolver()
+        with Ar.ResolverContextBinder(ctx):
+            resolver.Resolve("layerA.usd")
+            resolver.Resolve("layerB.usd")
+            # Cache hits don't query Python
+            resolver.Resolve("layerA.usd")
+        self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 2)
+        query_statistics = ctx.GetQueryStatistics()
+        self.assertEqual(query_statistics["queryCount"], 2)
+        self.assertEqual(query_statistics["deduplicatedQueryCount"], 0)
+        self.assertGreaterEqual(query_statistics["lockWaitTime"], 0)
+        ctx.ResetQueryStatistics()
+        self.assertEqual(ctx.GetQueryStatistics()["queryCount"], 0)
+
+    @unittest.skipUnless(sys.platform.startswith("linux"), "The shared memory cache test requires /dev/shm.")
+    def test_ResolverSharedMemoryCache(self):
+        # The shared memory cache gets initialized once per process,
+        # so we test it with separate processes.
+        segment_name = "arCachedResolverUnitTest{}".format(os.getpid())
+        process_code = "\n".join(
+            [
+                "from pxr import Ar",
+                "from usdAssetResolver import CachedResolver",
+                "import PythonExpose",
+                "import sys",
+                "ctx = CachedResolver.ResolverContext()",
+                "if len(sys.argv) > 1:",
+                "    ctx.ClearAndReinitialize()",
+                "with Ar.ResolverContextBinder(ctx):",
+                "    Ar.GetResolver().Resolve('sharedMemory.usd')",
+                "print(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter,",
+                "      ctx.GetCachingPairs()['sharedMemory.usd'],",
+                "      int(ctx.GetQueryStatistics()['sharedMemoryHitCount']))",
+            ]
+        )
+        process_env = dict(os.environ)
+        process_env["AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE"] = segment_name
+        process_env["AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE_SIZE"] = "1"
+        try:
+            # The first process queries Python and populates the shared memory cache
+            output = subprocess.check_output([sys.executable, "-c", process_code], env=process_env)
+            self.assertEqual(output.decode().split(), ["1", "/some/path/to/a/file.usd", "0"])
+            # The second process gets served by the shared memory cache
+            output = subprocess.check_output([sys.executable, "-c", process_code], env=process_env)
+            self.assertEqual(output.decode().split(), ["0", "/some/path/to/a/file.usd", "1"])
+            # Cleared contexts don't get served (possibly outdated) shared results
+            output = subprocess.check_output([sys.executable, "-c", process_code, "clear"], env=process_env)
+            self.assertEqual(output.decode().split(), ["1", "/some/path/to/a/file.usd", "0"])
+            # The segment is only accessible by the creating user
+            segment_file_path = os.path.join("/dev/shm", segment_name)
+            self.assertEqual(os.stat(segment_file_path).st_mode & 0o777, 0o600)
+        finally:
+            segment_file_path = os.path.join("/dev/shm", segment_name)
+            if os.path.exists(segment_file_path):
+                os.remove(segment_file_path)
+
+    def test_ResolverSharedMemoryCacheWithBatching(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            layer = Sdf.Layer.CreateAnonymous()
+            layer.subLayerPaths.append("sublayerA.usd")
+            layer.subLayerPaths.append("sublayerB.usd")
+            layer.Export(layer_file_path)
+            segment_name = "arCachedResolverBatchUnitTest{}".format(os.getpid())
+            process_code = "\n".join(
+                [
+                    "from pxr import Ar, Sdf",
+                    "from usdAssetResolver import CachedResolver",
+                    "import PythonExpose",
+                    "import sys",
+                    "layer = Sdf.Layer.FindOrOpen(sys.argv[1])",
+                    "ctx = CachedResolver.ResolverContext()",
+                    "Ar.GetUnderlyingResolver().SetBatchResolveLayerDependenciesState(True)",
+                    "with Ar.ResolverContextBinder(ctx):",
+                    "    Ar.GetResolver().CreateIdentifier('sublayerA.usd', Ar.ResolvedPath(layer.realPath))",
+                    "print(PythonExpose.UnitTestHelper.resolve_and_cache_batch_call_counter,",
+                    "      ctx.GetCachingPairs()['sublayerB.usd'],",
+                    "      int(ctx.GetQueryStatistics()['sharedMemoryHitCount']))",
+                ]
+            )
+            process_env = dict(os.environ)
+            process_env["AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE"] = segment_name
+            process_env["AR_CACHEDRESOLVER_SHARED_MEMORY_CACHE_SIZE"] = "1"
+            try:
+                # The first process batch queries Python and populates the shared memory cache
+                output = subprocess.check_output([sys.executable, "-c", process_code, layer_file_path], env=process_env)
+                self.assertEqual(output.decode().split(), ["1", "/some/path/to/a/file.usd", "0"])
+                # The second process gets served by the shared memory cache without a batch query
+                output = subprocess.check_output([sys.executable, "-c", process_code, layer_file_path], env=process_env)
+                self.assertEqual(output.decode().split(), ["0", "/some/path/to/a/file.usd", "2"])
+            finally:
+                segment_file_path = os.path.join("/dev/shm", segment_name)
+                if os.path.exists(segment_file_path):
+                    os.remove(segment_file_path)
+
+    def test_ResolverNativeHooksFallback(self):
+        # The native hook library gets loaded once per process,
+        # so we test it with a separate process.
+        process_code = "\n".join(
+            [
+                "from pxr import Ar",
+                "from usdAssetResolver import CachedResolver",
+                "ctx = CachedResolver.ResolverContext()",
+                "with Ar.ResolverContextBinder(ctx):",
+                "    Ar.GetResolver().ResetStatistics()",
+                "    Ar.GetResolver().Resolve('nativeHooks.usd')",
+                "statistics = Ar.GetResolver().GetStatistics()",
+                "print(int(statistics['nativeCallCount']), int(statistics['pythonCallCount']),",
+                "      ctx.GetCachingPairs()['nativeHooks.usd'])",
+            ]
+        )
+        process_env = dict(os.environ)
+        process_env["AR_CACHEDRESOLVER_NATIVE_HOOKS"] = "/some/path/to/a/missing/libNativeHooks.so"
+        # A library that fails to load falls back to the Python hooks
+        output = subprocess.check_output([sys.executable, "-c", process_code], env=process_env, stderr=subprocess.DEVNULL)
+        self.assertEqual(output.decode().split(), ["0", "1", "/some/path/to/a/file.usd"])
+
     def test_ResolveWithContext(self):
         with tempfile.TemporaryDirectory() as temp_dir_path:
             # Create files
@@ -515,6 +822,255 @@ class TestArResolver(unittest.TestCase):
                 resolved_path = resolver.Resolve(layer_v001_identifier)
                 self.assertEqual(resolved_path.GetPathString(), layer_v002_file_path)
 
+    def test_ResolveWithPrefixMappingPairs(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_file_paths = {}
+            for identifier in ["pin/assetA_latest/model.usd", "pin/assetA_geo/model.usd", "pin/override.usd"]:
+                layer_file_path = os.path.join(temp_dir_path, identifier)
+                os.makedirs(os.path.dirname(layer_file_path), exist_ok=True)
+                Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+                layer_file_paths[identifier] = layer_file_path
+            # Create context
+            ctx = CachedResolver.ResolverContext()
+            ctx.AddPrefixMappingPair("assets/assetA/", os.path.join(temp_dir_path, "pin/assetA_latest/"))
+            ctx.AddPrefixMappingPair("assets/assetA/geo/", os.path.join(temp_dir_path, "pin/assetA_geo/"))
+            self.assertEqual(
+                ctx.GetPrefixMappingPairs(),
+                {
+                    "assets/assetA/": os.path.join(temp_dir_path, "pin/assetA_latest/"),
+                    "assets/assetA/geo/": os.path.join(temp_dir_path, "pin/assetA_geo/"),
+                },
+            )
+            # Get resolver
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                # Prefix match
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/model.usd").GetPathString(),
+                    layer_file_paths["pin/assetA_latest/model.usd"],
+                )
+                # Longest prefix match
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(),
+                    layer_file_paths["pin/assetA_geo/model.usd"],
+                )
+                # Exact mapping pairs have priority
+                ctx.AddMappingPair("assets/assetA/geo/model.usd", os.path.join(temp_dir_path, "pin/override.usd"))
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(),
+                    layer_file_paths["pin/override.usd"],
+                )
+                ctx.RemoveMappingByKey("assets/assetA/geo/model.usd")
+                # Remove/Clear
+                ctx.RemovePrefixMappingByKey("assets/assetA/geo/")
+                self.assertEqual(
+                    ctx.GetPrefixMappingPairs(),
+                    {"assets/assetA/": os.path.join(temp_dir_path, "pin/assetA_latest/")},
+                )
+                self.assertEqual(resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(), "")
+                ctx.ClearPrefixMappingPairs()
+                self.assertEqual(ctx.GetPrefixMappingPairs(), {})
+
+    def test_ResolveWithResolveRules(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            asset_a_layer_file_path = os.path.join(temp_dir_path, "assets", "assetA", "assetA_v001.usd")
+            os.makedirs(os.path.dirname(asset_a_layer_file_path))
+            Sdf.Layer.CreateAnonymous().Export(asset_a_layer_file_path)
+            # Create mapping file
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usda")
+            mapping_layer = Sdf.Layer.CreateAnonymous()
+            mapping_layer.customLayerData = {
+                CachedResolver.Tokens.resolveRules: Vt.StringArray(
+                    [r"assets/(\w+)", os.path.join(temp_dir_path, "assets", "$1", "$1_v001.usd")]
+                )
+            }
+            mapping_layer.Export(mapping_file_path)
+            # Create context
+            PythonExpose.UnitTestHelper.reset()
+            ctx = CachedResolver.ResolverContext(mapping_file_path)
+            self.assertEqual(
+                ctx.GetResolveRules(),
+                [(r"assets/(\w+)", os.path.join(temp_dir_path, "assets", "$1", "$1_v001.usd"))],
+            )
+            # Invalid regex expressions are skipped
+            self.assertEqual(ctx.AddResolveRule("(unbalanced", "invalid"), False)
+            self.assertEqual(len(ctx.GetResolveRules()), 1)
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                # Rule matches don't call into Python and are cached
+                self.assertEqual(resolver.Resolve("assets/assetA").GetPathString(), asset_a_layer_file_path)
+                self.assertEqual(resolver.Resolve("assets/assetA").GetPathString(), asset_a_layer_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 0)
+                self.assertEqual(ctx.GetCachingPairs()["assets/assetA"], asset_a_layer_file_path)
+                # Everything else still goes through Python
+                resolver.Resolve("shots/shotA")
+                self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 1)
+                # Clear
+                ctx.ClearResolveRules()
+                self.assertEqual(ctx.GetResolveRules(), [])
+                ctx.ClearCachingPairs()
+                resolver.Resolve("assets/assetA")
+                self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 2)
+
+    def test_ResolveWithPrecomputedCachingPairs(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            asset_a_layer_file_path = os.path.join(temp_dir_path, "assetA.usd")
+            Sdf.Layer.CreateAnonymous().Export(asset_a_layer_file_path)
+            # Create mapping file (as written by the cachedResolverWarm tool)
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usda")
+            mapping_layer = Sdf.Layer.CreateAnonymous()
+            mapping_layer.customLayerData = {
+                CachedResolver.Tokens.cachingPairs: Vt.StringArray(["assets/assetA", asset_a_layer_file_path])
+            }
+            mapping_layer.Export(mapping_file_path)
+            # Create context
+            PythonExpose.UnitTestHelper.reset()
+            ctx = CachedResolver.ResolverContext(mapping_file_path)
+            self.assertEqual(ctx.GetCachingPairs()["assets/assetA"], asset_a_layer_file_path)
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                # Pre-computed caching pairs don't call into Python
+                self.assertEqual(resolver.Resolve("assets/assetA").GetPathString(), asset_a_layer_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 0)
+                # They are re-loaded on re-initialization
+                ctx.ClearAndReinitialize()
+                self.assertEqual(ctx.GetCachingPairs()["assets/assetA"], asset_a_layer_file_path)
+
+    def test_ClearPairsWhileResolving(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            ctx = CachedResolver.ResolverContext()
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                for idx in range(100):
+                    ctx.AddMappingPair("mapped{}".format(idx), layer_file_path)
+                    ctx.AddCachingPair("cached{}".format(idx), layer_file_path)
+                self.assertEqual(resolver.Resolve("mapped0").GetPathString(), layer_file_path)
+                # Clearing invalidates all pairs at once
+                ctx.ClearMappingPairs()
+                ctx.ClearCachingPairs()
+                self.assertEqual(ctx.GetMappingPairs(), {})
+                self.assertNotIn("cached0", ctx.GetCachingPairs())
+                # Pairs added after the clear are visible right away
+                ctx.AddMappingPair("mapped0", layer_file_path)
+                self.assertEqual(ctx.GetMappingPairs(), {"mapped0": layer_file_path})
+                self.assertEqual(resolver.Resolve("mapped0").GetPathString(), layer_file_path)
+
+    def test_ReloadFromMappingFilePath(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            asset_layer_file_paths = {}
+            for asset_name in ["assetA", "assetB"]:
+                for version in ["v001", "v002"]:
+                    layer_file_path = os.path.join(temp_dir_path, "assets", asset_name, "{}_{}.usd".format(asset_name, version))
+                    os.makedirs(os.path.dirname(layer_file_path), exist_ok=True)
+                    Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+                    asset_layer_file_paths[(asset_name, version)] = layer_file_path
+            # Create mapping file
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usda")
+            mapping_layer = Sdf.Layer.CreateAnonymous()
+            mapping_layer.customLayerData = {
+                CachedResolver.Tokens.mappingPairs: Vt.StringArray(
+                    ["assetA", asset_layer_file_paths[("assetA", "v001")], "assetB", asset_layer_file_paths[("assetB", "v001")]]
+                )
+            }
+            mapping_layer.Export(mapping_file_path)
+            # Create context
+            ctx = CachedResolver.ResolverContext(mapping_file_path)
+            ctx.AddCachingPair("shots/shotA", asset_layer_file_paths[("assetB", "v002")])
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                asset_a_layer = Sdf.Layer.FindOrOpen("assetA")
+                asset_b_layer = Sdf.Layer.FindOrOpen("assetB")
+                self.assertEqual(asset_a_layer.resolvedPath.GetPathString(), asset_layer_file_paths[("assetA", "v001")])
+                # Re-pin a single asset
+                mapping_layer.customLayerData = {
+                    CachedResolver.Tokens.mappingPairs: Vt.StringArray(
+                        ["assetA", asset_layer_file_paths[("assetA", "v002")], "assetB", asset_layer_file_paths[("assetB", "v001")]]
+                    )
+                }
+                mapping_layer.Export(mapping_file_path)
+                self.assertEqual(ctx.ReloadFromMappingFilePath(), True)
+                self.assertEqual(ctx.GetMappingPairs()["assetA"], asset_layer_file_paths[("assetA", "v002")])
+                # Unaffected pairs are kept
+                self.assertEqual(ctx.GetCachingPairs()["shots/shotA"], asset_layer_file_paths[("assetB", "v002")])
+                # Only the layers of the changed pairs get reloaded
+                resolver_changed_notices = []
+                listener = Tf.Notice.RegisterGlobally(Ar.Notice.ResolverChanged, lambda notice, sender: resolver_changed_notices.append(notice))
+                resolver.RefreshContext(ctx)
+                self.assertEqual(asset_a_layer.resolvedPath.GetPathString(), asset_layer_file_paths[("assetA", "v002")])
+                self.assertEqual(asset_b_layer.resolvedPath.GetPathString(), asset_layer_file_paths[("assetB", "v001")])
+                self.assertEqual(len(resolver_changed_notices), 0)
+                # Changed identifiers that aren't loaded as a layer still notify the stages
+                del asset_b_layer
+                mapping_layer.customLayerData = {
+                    CachedResolver.Tokens.mappingPairs: Vt.StringArray(
+                        ["assetA", asset_layer_file_paths[("assetA", "v002")], "assetB", asset_layer_file_paths[("assetB", "v002")]]
+                    )
+                }
+                mapping_layer.Export(mapping_file_path)
+                self.assertEqual(ctx.ReloadFromMappingFilePath(), True)
+                resolver.RefreshContext(ctx)
+                self.assertEqual(len(resolver_changed_notices), 1)
+                listener.Revoke()
+                # Prefix mapping pair changes require a full reload
+                mapping_layer.customLayerData = {
+                    CachedResolver.Tokens.mappingPairs: Vt.StringArray(
+                        ["assetA", asset_layer_file_paths[("assetA", "v002")], "assetB", asset_layer_file_paths[("assetB", "v001")]]
+                    ),
+                    CachedResolver.Tokens.prefixMappingPairs: Vt.StringArray(["shots/", os.path.join(temp_dir_path, "shots/")]),
+                }
+                mapping_layer.Export(mapping_file_path)
+                self.assertEqual(ctx.ReloadFromMappingFilePath(), False)
+                self.assertNotIn("shots/shotA", ctx.GetCachingPairs())
+
+    def test_ResolveLatestVersion(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            asset_dir_path = os.path.join(temp_dir_path, "assets", "assetA")
+            os.makedirs(asset_dir_path)
+            for file_name in ["assetA_v001.usd", "assetA_v002.usd", "assetA_v010.usd", "assetA_vXYZ.usd", "assetA_v011.usda"]:
+                Sdf.Layer.CreateAnonymous().Export(os.path.join(asset_dir_path, file_name))
+            cached_resolver = Ar.GetUnderlyingResolver()
+            cached_resolver.ClearDirectoryListingCache()
+            ctx = CachedResolver.ResolverContext()
+            # Python API
+            self.assertEqual(
+                ctx.ResolveLatestVersion(os.path.join(asset_dir_path, "assetA_v{latest}.usd")),
+                os.path.join(asset_dir_path, "assetA_v010.usd"),
+            )
+            self.assertEqual(ctx.ResolveLatestVersion(os.path.join(asset_dir_path, "assetB_v{latest}.usd")), "")
+            self.assertEqual(ctx.ResolveLatestVersion(os.path.join(temp_dir_path, "missing", "assetA_v{latest}.usd")), "")
+            # Resolve rules
+            ctx.AddResolveRule(r"assets/(\w+)", os.path.join(temp_dir_path, "assets", "$1", "$1_v{latest}.usd"))
+            resolver = Ar.GetResolver()
+            PythonExpose.UnitTestHelper.reset()
+            with Ar.ResolverContextBinder(ctx):
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA").GetPathString(),
+                    os.path.join(asset_dir_path, "assetA_v010.usd"),
+                )
+                self.assertEqual(PythonExpose.UnitTestHelper.resolve_and_cache_call_counter, 0)
+            # New versions are picked up once the listing got invalidated
+            Sdf.Layer.CreateAnonymous().Export(os.path.join(asset_dir_path, "assetA_v0100.usd"))
+            cached_resolver.ClearDirectoryListingCache()
+            self.assertEqual(
+                ctx.ResolveLatestVersion(os.path.join(asset_dir_path, "assetA_v{latest}.usd")),
+                os.path.join(asset_dir_path, "assetA_v0100.usd"),
+            )
+            # Versions published in the same second the listing was read are picked up after the stat interval
+            Sdf.Layer.CreateAnonymous().Export(os.path.join(asset_dir_path, "assetA_v0101.usd"))
+            time.sleep(1.1)
+            self.assertEqual(
+                ctx.ResolveLatestVersion(os.path.join(asset_dir_path, "assetA_v{latest}.usd")),
+                os.path.join(asset_dir_path, "assetA_v0101.usd"),
+            )
+            cached_resolver.ClearDirectoryListingCache()
+
     def test_ResolveWithCacheContextRefresh(self):
         """This test currently does not work.
         # ToDo Investigate why RefreshContext doesn't flush ResolverScopedCaches
@@ -551,6 +1107,22 @@ class TestArResolver(unittest.TestCase):
                     stage.ResolveIdentifierToEditTarget(layer_a_identifier),
                 )
 
+    def test_ResolverContextRegistry(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create mapping file
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usd")
+            Sdf.Layer.CreateAnonymous().Export(mapping_file_path)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            PythonExpose.UnitTestHelper.reset()
+            # Stages opening the same mapping file share the same (registered) context
+            ctx_a = resolver.CreateDefaultContextForAsset(mapping_file_path).Get()[0]
+            self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 1)
+            ctx_b = resolver.CreateDefaultContextForAsset(mapping_file_path).Get()[0]
+            self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 1)
+            ctx_a.AddCachingPair("assets/assetA/assetA.usd", "/some/path/to/assetA.usd")
+            self.assertEqual(ctx_b.GetCachingPairs(), ctx_a.GetCachingPairs())
+
     def test_ResolverContextHash(self):
         self.assertEqual(
             hash(CachedResolver.ResolverContext()), hash(CachedResolver.ResolverContext())
@@ -577,11 +1149,14 @@ class TestArResolver(unittest.TestCase):
                 "assets/assetA/assetA.usd": "assets/assetA/assetA_v005.usd",
                 "shots/shotA/shotA_v000.usd": "shots/shotA/shotA_v003.usd",
             }
-            mapping_array = []
+            # Duplicate keys are overridden by later pairs
+            mapping_array = ["assets/assetA/assetA.usd", "assets/assetA/assetA_v001.usd"]
             for source_path, target_path in mapping_pairs.items():
                 mapping_array.extend([source_path, target_path])
+            prefix_mapping_pairs = {"assets/assetB/": "assets/assetB_v002/"}
             mapping_layer.customLayerData = {
-                CachedResolver.Tokens.mappingPairs: Vt.StringArray(mapping_array)
+                CachedResolver.Tokens.mappingPairs: Vt.StringArray(mapping_array),
+                CachedResolver.Tokens.prefixMappingPairs: Vt.StringArray(["assets/assetB/", "assets/assetB_v002/"]),
             }
             mapping_layer.Export(mapping_file_path)
 
@@ -589,6 +1164,7 @@ class TestArResolver(unittest.TestCase):
             ctx = CachedResolver.ResolverContext(mapping_file_path)
             self.assertEqual(ctx.GetMappingFilePath(), mapping_file_path)
             self.assertEqual(ctx.GetMappingPairs(), mapping_pairs)
+            self.assertEqual(ctx.GetPrefixMappingPairs(), prefix_mapping_pairs)
             # Test mapping add
             mapping_pairs_updated = {k: v for k, v in ctx.GetMappingPairs().items()}
             ctx.AddMappingPair("example/cube", "example/sphere")
@@ -617,6 +1193,85 @@ class TestArResolver(unittest.TestCase):
             ctx.RefreshFromMappingFilePath()
             self.assertEqual(ctx.GetMappingPairs(), mapping_pairs)
 
+    def test_ResolverContextSnapshot(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create mapping file
+            mapping_file_path = os.path.join(temp_dir_path, "mapping.usd")
+            mapping_layer = Sdf.Layer.CreateAnonymous()
+            mapping_layer.customLayerData = {
+                CachedResolver.Tokens.mappingPairs: Vt.StringArray(
+                    ["assets/assetA/assetA.usd", "assets/assetA/assetA_v005.usd"]
+                )
+            }
+            mapping_layer.Export(mapping_file_path)
+            snapshot_dir_path = os.path.join(temp_dir_path, "snapshots")
+            # Snapshots are disabled by default
+            ctx = CachedResolver.ResolverContext(mapping_file_path)
+            self.assertFalse(ctx.SaveSnapshot())
+            os.environ["AR_CACHEDRESOLVER_SNAPSHOT_DIR"] = snapshot_dir_path
+            try:
+                PythonExpose.UnitTestHelper.reset()
+                # Create context (this initializes via Python and writes the snapshot)
+                ctx = CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 1)
+                ctx.AddCachingPair("assets/assetB/assetB.usd", "/some/path/to/assetB.usd")
+                self.assertTrue(ctx.SaveSnapshot())
+                # A new context with the same mapping file starts warm
+                ctx_warm = CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 1)
+                self.assertEqual(ctx_warm.GetMappingPairs(), ctx.GetMappingPairs())
+                self.assertEqual(ctx_warm.GetCachingPairs(), ctx.GetCachingPairs())
+                # Caching pairs added later on are flushed
+                self.assertFalse(ctx_warm.FlushSnapshot())
+                ctx_warm.AddCachingPair("assets/assetC/assetC.usd", "/some/path/to/assetC.usd")
+                self.assertTrue(ctx_warm.FlushSnapshot())
+                self.assertFalse(ctx_warm.FlushSnapshot())
+                ctx_flushed = CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(ctx_flushed.GetCachingPairs()["assets/assetC/assetC.usd"], "/some/path/to/assetC.usd")
+                # The last copy of a context flushes on destruction
+                ctx_flushed.AddCachingPair("assets/assetD/assetD.usd", "/some/path/to/assetD.usd")
+                del ctx_flushed
+                ctx_flushed = CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(ctx_flushed.GetCachingPairs()["assets/assetD/assetD.usd"], "/some/path/to/assetD.usd")
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 1)
+                # Edits on top of the snapshot
+                ctx_warm.RemoveCachingByKey("assets/assetB/assetB.usd")
+                self.assertNotIn("assets/assetB/assetB.usd", ctx_warm.GetCachingPairs())
+                ctx_warm.RemoveMappingByValue("assets/assetA/assetA_v005.usd")
+                self.assertEqual(ctx_warm.GetMappingPairs(), {})
+                # Edited contexts are not flushed
+                ctx_warm.AddCachingPair("assets/assetE/assetE.usd", "/some/path/to/assetE.usd")
+                self.assertFalse(ctx_warm.FlushSnapshot())
+                # Stale snapshots are ignored
+                mapping_layer.Export(mapping_file_path)
+                os.utime(mapping_file_path, (0, 0))
+                ctx_stale = CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 2)
+                self.assertNotIn("assets/assetB/assetB.usd", ctx_stale.GetCachingPairs())
+                # Corrupt snapshots are ignored if the checksum verification is enabled
+                for snapshot_file_name in os.listdir(snapshot_dir_path):
+                    with open(os.path.join(snapshot_dir_path, snapshot_file_name), "r+b") as snapshot_file:
+                        snapshot_file.seek(-1, os.SEEK_END)
+                        snapshot_file.write(b"#")
+                os.environ["AR_CACHEDRESOLVER_SNAPSHOT_VERIFY"] = "1"
+                try:
+                    ctx_corrupt = CachedResolver.ResolverContext(mapping_file_path)
+                finally:
+                    os.environ.pop("AR_CACHEDRESOLVER_SNAPSHOT_VERIFY")
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 3)
+                self.assertEqual(
+                    ctx_corrupt.GetMappingPairs(),
+                    {"assets/assetA/assetA.usd": "assets/assetA/assetA_v005.usd"},
+                )
+                # Truncated snapshots are always ignored
+                for snapshot_file_name in os.listdir(snapshot_dir_path):
+                    snapshot_file_path = os.path.join(snapshot_dir_path, snapshot_file_name)
+                    os.truncate(snapshot_file_path, os.path.getsize(snapshot_file_path) - 1)
+                CachedResolver.ResolverContext(mapping_file_path)
+                self.assertEqual(PythonExpose.UnitTestHelper.context_initialize_call_counter, 4)
+            finally:
+                os.environ.pop("AR_CACHEDRESOLVER_SNAPSHOT_DIR")
+
     def test_ResolverContextCachingPairs(self):
         with tempfile.TemporaryDirectory() as temp_dir_path:
             ctx = CachedResolver.ResolverContext()
@@ -649,5 +1304,71 @@ class TestArResolver(unittest.TestCase):
             self.assertEqual(ctx.GetCachingPairs(), {'shot.usd': '/some/path/to/a/file.usd'})
 
 
+    def test_ResolverStatistics(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = "layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Create context
+            ctx = CachedResolver.ResolverContext()
+            ctx.AddMappingPair("mapped.usd", layer_file_path)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            resolver.ResetStatistics()
+            statistics = resolver.GetStatistics()
+            self.assertEqual(statistics["resolveCount"], 0)
+            self.assertEqual(statistics["pythonTime"], 0.0)
+            with Ar.ResolverContextBinder(ctx):
+                resolver.Resolve("mapped.usd")
+                # The first resolve of an uncached asset path queries Python
+                resolver.Resolve(layer_identifier)
+                resolver.Resolve(layer_identifier)
+            statistics = resolver.GetStatistics()
+            self.assertEqual(statistics["resolveCount"], 3)
+            self.assertEqual(statistics["mappingHitCount"], 1)
+            self.assertEqual(statistics["cacheMissCount"], 1)
+            self.assertEqual(statistics["cacheHitCount"], 1)
+            self.assertEqual(statistics["pythonCallCount"], 1)
+            self.assertGreater(statistics["pythonTime"], 0.0)
+            self.assertGreaterEqual(statistics["statCallCount"], 1)
+            # Reset
+            resolver.ResetStatistics()
+            self.assertEqual(resolver.GetStatistics()["resolveCount"], 0)
+
+
+    def test_ResolverReadAheadStatistics(self):
+        cached_resolver = Ar.GetUnderlyingResolver()
+        cached_resolver.ResetReadAheadStatistics()
+        statistics = cached_resolver.GetReadAheadStatistics()
+        self.assertEqual(
+            statistics,
+            {"prefetchCount": 0, "droppedCount": 0, "hitCount": 0, "lateCount": 0, "missCount": 0},
+        )
+        # The read-ahead is disabled by default, so nothing gets counted.
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            Usd.Stage.Open(layer_file_path)
+            self.assertEqual(cached_resolver.GetReadAheadStatistics(), statistics)
+
+    def test_ResolverAssetCacheStatistics(self):
+        cached_resolver = Ar.GetUnderlyingResolver()
+        cached_resolver.ClearAssetCache()
+        statistics = cached_resolver.GetAssetCacheStatistics()
+        self.assertEqual(
+            sorted(statistics.keys()),
+            ["entryCount", "evictionCount", "hitCount", "missCount", "usedBytes"],
+        )
+        # The asset cache is disabled by default, so opened files don't get cached.
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            layer_file_path = os.path.join(temp_dir_path, "layer.usd")
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            Usd.Stage.Open(layer_file_path)
+            self.assertEqual(cached_resolver.GetAssetCacheStatistics(), statistics)
+            self.assertEqual(statistics["entryCount"], 0)
+            self.assertEqual(statistics["usedBytes"], 0)
+
+
 if __name__ == "__main__":
     unittest.main()
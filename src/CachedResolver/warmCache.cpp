@@ -0,0 +1,221 @@
+#include "resolverContext.h"
+#include "resolverTokens.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/tf/pathUtils.h"
+#include "pxr/base/tf/pyUtils.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/base/vt/dictionary.h"
+#include "pxr/base/work/loops.h"
+#include "pxr/base/work/threadLimits.h"
+#include "pxr/usd/ar/resolver.h"
+#include "pxr/usd/ar/resolverContext.h"
+#include "pxr/usd/ar/resolverContextBinder.h"
+#include "pxr/usd/sdf/fileFormat.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usdUtils/dependencies.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+/* Cached Resolver Warm
+Walks the full dependency closure (sublayers, references, payloads, asset attributes)
+of a root layer, resolves every identifier through the CachedResolver and writes the
+resulting caching pairs to a mapping file. Contexts created from this mapping file bulk
+load the caching pairs, so that e.g. farm jobs of a shot start without any Python queries.
+The mapping pairs, prefix mapping pairs, identifier templates and resolve rules of the
+context's mapping file are copied to the output file.
+
+Layers are loaded in parallel, one dependency level at a time.
+*/
+
+static const char* g_usage =
+    "Usage: cachedResolverWarm <rootLayer> <outputMappingFile> [--mapping-file <mappingFile>] [--threads <threadCount>]\n"
+    "  rootLayer          The layer to warm the resolve set of.\n"
+    "  outputMappingFile  The (.usd/.usda/.usdc) file to write the mapping and caching pairs to.\n"
+    "  --mapping-file     The mapping file of the context, by default the context is created\n"
+    "                     the same way DCCs do (Resolver.CreateDefaultContextForAsset(rootLayer)).\n"
+    "  --threads          The number of threads to load layers with, defaults to all cores.\n";
+
+struct _WarmStatistics
+{
+    std::atomic<size_t> layerCount{0};
+    std::atomic<size_t> failedLayerCount{0};
+    std::atomic<size_t> identifierCount{0};
+    std::atomic<size_t> unresolvedIdentifierCount{0};
+};
+
+static void
+_WarmLayer(const std::string& layerIdentifier,
+           std::mutex& visitedLayersMutex,
+           std::unordered_set<std::string>& visitedLayers,
+           std::vector<std::string>& nextLayerIdentifiers,
+           _WarmStatistics& statistics)
+{
+    SdfLayerRefPtr layer = SdfLayer::FindOrOpen(layerIdentifier);
+    if (!layer) {
+        std::cerr << "Failed to open layer '" << layerIdentifier << "'." << std::endl;
+        statistics.failedLayerCount++;
+        return;
+    }
+    statistics.layerCount++;
+    std::vector<std::string> subLayers, references, payloads;
+    UsdUtilsExtractExternalReferences(layer->GetIdentifier(), &subLayers, &references, &payloads);
+    ArResolver& resolver = ArGetResolver();
+    for (const std::vector<std::string>* assetPaths : {&subLayers, &references, &payloads}) {
+        for (const std::string& assetPath : *assetPaths) {
+            const std::string identifier = resolver.CreateIdentifier(assetPath, layer->GetResolvedPath());
+            const ArResolvedPath resolvedPath = resolver.Resolve(identifier);
+            statistics.identifierCount++;
+            if (!resolvedPath) {
+                statistics.unresolvedIdentifierCount++;
+                continue;
+            }
+            // References also hold non layer assets (e.g. textures), these only need to be resolved.
+            if (!SdfFileFormat::FindByExtension(resolvedPath.GetPathString())) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(visitedLayersMutex);
+            if (visitedLayers.insert(resolvedPath.GetPathString()).second) {
+                nextLayerIdentifiers.push_back(identifier);
+            }
+        }
+    }
+}
+
+static bool
+_WriteMappingFile(const std::string& outputFilePath,
+                  const std::string& mappingFilePath,
+                  const std::map<std::string, std::string>& cachingPairs)
+{
+    VtDictionary customLayerData;
+    if (!mappingFilePath.empty()) {
+        SdfLayerRefPtr mappingLayer = SdfLayer::FindOrOpen(mappingFilePath);
+        if (!mappingLayer) {
+            std::cerr << "Failed to open mapping file '" << mappingFilePath << "'." << std::endl;
+            return false;
+        }
+        const VtDictionary mappingLayerData = mappingLayer->GetCustomLayerData();
+        for (const TfToken& token : CachedResolverTokens->allTokens) {
+            auto it = mappingLayerData.find(token.GetString());
+            if (it != mappingLayerData.end()) {
+                customLayerData[token.GetString()] = it->second;
+            }
+        }
+    }
+    VtStringArray cachingDataArray;
+    cachingDataArray.reserve(cachingPairs.size() * 2);
+    for (const auto& it : cachingPairs) {
+        cachingDataArray.push_back(it.first);
+        cachingDataArray.push_back(it.second);
+    }
+    customLayerData[CachedResolverTokens->cachingPairs.GetString()] = VtValue(cachingDataArray);
+    SdfLayerRefPtr outputLayer = SdfLayer::CreateNew(outputFilePath);
+    if (!outputLayer) {
+        std::cerr << "Failed to create output mapping file '" << outputFilePath << "'." << std::endl;
+        return false;
+    }
+    outputLayer->SetCustomLayerData(customLayerData);
+    return outputLayer->Save();
+}
+
+int
+main(int argc, char* argv[])
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::string> positionalArgs;
+    std::string mappingFilePath;
+    int threadCount = 0;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::cout << g_usage;
+            return EXIT_SUCCESS;
+        } else if (arg == "--mapping-file" && i + 1 < argc) {
+            mappingFilePath = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::atoi(argv[++i]);
+        } else if (!TfStringStartsWith(arg, "--")) {
+            positionalArgs.push_back(arg);
+        } else {
+            std::cerr << "Unknown argument '" << arg << "'.\n" << g_usage;
+            return EXIT_FAILURE;
+        }
+    }
+    if (positionalArgs.size() != 2) {
+        std::cerr << g_usage;
+        return EXIT_FAILURE;
+    }
+    const std::string& rootLayerPath = positionalArgs[0];
+    const std::string& outputFilePath = positionalArgs[1];
+    const Clock::time_point startTime = Clock::now();
+
+    // The Python hooks are called from the worker threads, so this has to
+    // happen upfront (this also releases the GIL again).
+    TfPyInitialize();
+    WorkSetConcurrencyLimitArgument(threadCount);
+
+    ArResolver& resolver = ArGetResolver();
+    const ArResolverContext context = mappingFilePath.empty() ? resolver.CreateDefaultContextForAsset(rootLayerPath)
+                                                              : ArResolverContext(CachedResolverContext(mappingFilePath));
+    const CachedResolverContext* ctx = context.Get<CachedResolverContext>();
+    if (!ctx) {
+        std::cerr << "The CachedResolver is not the active asset resolver, please check your PXR_PLUGINPATH_NAME." << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (TfAbsPath(outputFilePath) == ctx->GetMappingFilePath()) {
+        std::cerr << "The output mapping file can't be the context's mapping file." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    _WarmStatistics statistics;
+    std::mutex visitedLayersMutex;
+    std::unordered_set<std::string> visitedLayers;
+    std::vector<std::string> layerIdentifiers;
+    {
+        ArResolverContextBinder binder(context);
+        const std::string rootLayerIdentifier = resolver.CreateIdentifier(rootLayerPath);
+        const ArResolvedPath rootLayerResolvedPath = resolver.Resolve(rootLayerIdentifier);
+        if (!rootLayerResolvedPath) {
+            std::cerr << "Failed to resolve root layer '" << rootLayerPath << "'." << std::endl;
+            return EXIT_FAILURE;
+        }
+        visitedLayers.insert(rootLayerResolvedPath.GetPathString());
+        layerIdentifiers.push_back(rootLayerIdentifier);
+    }
+    while (!layerIdentifiers.empty()) {
+        std::vector<std::string> nextLayerIdentifiers;
+        WorkParallelForN(layerIdentifiers.size(), [&](size_t begin, size_t end){
+            // Context bindings are per thread.
+            ArResolverContextBinder binder(context);
+            for (size_t i = begin; i < end; i++) {
+                _WarmLayer(layerIdentifiers[i], visitedLayersMutex, visitedLayers, nextLayerIdentifiers, statistics);
+            }
+        });
+        layerIdentifiers.swap(nextLayerIdentifiers);
+    }
+
+    const std::map<std::string, std::string> cachingPairs = ctx->GetCachingPairs();
+    if (!_WriteMappingFile(outputFilePath, ctx->GetMappingFilePath(), cachingPairs)) {
+        return EXIT_FAILURE;
+    }
+    // Contexts that are created for the original mapping file (e.g. by husk) pick up the
+    // warmed caching pairs via the snapshot, if snapshots are enabled.
+    ctx->SaveSnapshot();
+
+    const double elapsedTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+    std::cout << "Warmed " << cachingPairs.size() << " caching pairs from " << statistics.layerCount << " layers ";
+    std::cout << "(" << statistics.identifierCount << " identifiers, " << statistics.unresolvedIdentifierCount << " unresolved, ";
+    std::cout << statistics.failedLayerCount << " failed layers) in " << elapsedTime << " seconds." << std::endl;
+    std::cout << "Written to '" << outputFilePath << "'." << std::endl;
+    return statistics.failedLayerCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
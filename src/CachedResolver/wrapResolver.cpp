@@ -5,8 +5,11 @@
 
 #include "boost_include_wrapper.h"
 #include BOOST_INCLUDE(python/class.hpp)
+#include BOOST_INCLUDE(python/enum.hpp)
 #include BOOST_INCLUDE(python/return_value_policy.hpp)
 
+#include "python_dict.h"
+
 using namespace AR_BOOST_NAMESPACE::python;
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -16,14 +19,33 @@ wrapResolver()
 {
     using This = CachedResolver;
 
+    enum_<CachedResolverRevalidationPolicy>("RevalidationPolicy")
+        .value("Never", CachedResolverRevalidationPolicy::Never)
+        .value("TimeToLive", CachedResolverRevalidationPolicy::TimeToLive)
+        .value("CacheScope", CachedResolverRevalidationPolicy::CacheScope)
+    ;
+
     class_<This, bases<ArResolver>, AR_BOOST_NAMESPACE::noncopyable>
         ("Resolver", no_init)
         .def("GetExposeRelativePathIdentifierState", &This::GetExposeRelativePathIdentifierState, return_value_policy<return_by_value>(), "Get the state of exposing relative path identifiers")
         .def("SetExposeRelativePathIdentifierState", &This::SetExposeRelativePathIdentifierState, "Set the state of exposing relative path identifiers")
+        .def("GetBatchResolveLayerDependenciesState", &This::GetBatchResolveLayerDependenciesState, return_value_policy<return_by_value>(), "Get the state of batch querying the context dependent identifiers of a layer")
+        .def("SetBatchResolveLayerDependenciesState", &This::SetBatchResolveLayerDependenciesState, "Set the state of batch querying the context dependent identifiers of a layer")
+        .def("GetRevalidationPolicy", &This::GetRevalidationPolicy, return_value_policy<return_by_value>(), "Get the revalidation policy of cached identifiers")
+        .def("SetRevalidationPolicy", &This::SetRevalidationPolicy, "Set the revalidation policy of cached identifiers")
+        .def("GetRevalidationTTL", &This::GetRevalidationTTL, return_value_policy<return_by_value>(), "Get the revalidation time to live in seconds")
+        .def("SetRevalidationTTL", &This::SetRevalidationTTL, "Set the revalidation time to live in seconds")
         .def("GetCachedRelativePathIdentifierPairs", &This::GetCachedRelativePathIdentifierPairs, return_value_policy<return_by_value>(), "Returns all cached relative path identifier pairs as a dict")
         .def("AddCachedRelativePathIdentifierPair", &This::AddCachedRelativePathIdentifierPair, "Add a cached relative path identifier pair")
         .def("RemoveCachedRelativePathIdentifierByKey", &This::RemoveCachedRelativePathIdentifierByKey, "Remove a cached relative path identifier pair by key")
         .def("RemoveCachedRelativePathIdentifierByValue", &This::RemoveCachedRelativePathIdentifierByValue, "Remove a cached relative path identifier pair by value")
         .def("ClearCachedRelativePathIdentifierPairs", &This::ClearCachedRelativePathIdentifierPairs, "Clear all cached relative path identifier pairs")
+        .def("ClearDirectoryListingCache", &This::ClearDirectoryListingCache, "Clear the cached directory listings of the latest version lookups")
+        .def("GetStatistics", GetPythonDict<&This::GetStatistics>, "Returns the resolver statistics (operation/cache hit/Python call counts and accumulated Python/lock wait time in seconds) as a dict")
+        .def("ResetStatistics", &This::ResetStatistics, "Reset the resolver statistics")
+        .def("GetReadAheadStatistics", GetPythonDict<&This::GetReadAheadStatistics>, "Returns the read-ahead prefetch/dropped counts and the hit (prefetch finished before open)/late (prefetch still pending on open)/miss (not prefetched) open counts as a dict")
+        .def("ResetReadAheadStatistics", &This::ResetReadAheadStatistics, "Reset the read-ahead statistics")
+        .def("GetAssetCacheStatistics", GetPythonDict<&This::GetAssetCacheStatistics>, "Returns the memory mapped asset cache hit/miss/eviction counts, the cached entry count and the cached bytes as a dict")
+        .def("ClearAssetCache", &This::ClearAssetCache, "Drop all cached memory mapped assets (assets that are still in use stay valid)")
     ;
 }
\ No newline at end of file
@@ -6,10 +6,17 @@
 
 #include "boost_include_wrapper.h"
 #include BOOST_INCLUDE(python/class.hpp)
+#include BOOST_INCLUDE(python/dict.hpp)
+#include BOOST_INCLUDE(python/list.hpp)
 #include BOOST_INCLUDE(python/operators.hpp)
 #include BOOST_INCLUDE(python/return_value_policy.hpp)
+#include BOOST_INCLUDE(python/tuple.hpp)
+
+#include "python_dict.h"
 
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace AR_BOOST_NAMESPACE::python;
 
@@ -31,6 +38,31 @@ _Repr(const CachedResolverContext& ctx)
             "('" + ctx.GetMappingFilePath() + "')");
 }
 
+static
+list
+_GetRules(const std::vector<std::pair<std::string, std::string>>& rules)
+{
+    list result;
+    for (const auto& it : rules) {
+        result.append(make_tuple(it.first, it.second));
+    }
+    return result;
+}
+
+static
+list
+_GetIdentifierTemplates(const CachedResolverContext& ctx)
+{
+    return _GetRules(ctx.GetIdentifierTemplates());
+}
+
+static
+list
+_GetResolveRules(const CachedResolverContext& ctx)
+{
+    return _GetRules(ctx.GetResolveRules());
+}
+
 void
 wrapResolverContext()
 {
@@ -47,16 +79,32 @@ wrapResolverContext()
         .def("GetMappingFilePath", &This::GetMappingFilePath, return_value_policy<return_by_value>(), "Get the mapping file path (Defaults to file that the context created via Resolver.CreateDefaultContextForAsset() opened")
         .def("SetMappingFilePath", &This::SetMappingFilePath, "Set the mapping file path")
         .def("RefreshFromMappingFilePath", &This::RefreshFromMappingFilePath, "Reload mapping pairs from the mapping file path")
+        .def("ReloadFromMappingFilePath", &This::ReloadFromMappingFilePath, "Reload only the changed mapping pairs from the mapping file path, returns False if a full reload was necessary")
         .def("GetMappingPairs", &This::GetMappingPairs, return_value_policy<return_by_value>(), "Returns all mapping pairs as a dict")
         .def("AddMappingPair", &This::AddMappingPair, "Add a mapping pair")
         .def("RemoveMappingByKey", &This::RemoveMappingByKey, "Remove a mapping pair by key")
         .def("RemoveMappingByValue", &This::RemoveMappingByValue, "Remove a mapping pair by value")
         .def("ClearMappingPairs", &This::ClearMappingPairs, "Clear all mapping pairs")
+        .def("GetPrefixMappingPairs", &This::GetPrefixMappingPairs, return_value_policy<return_by_value>(), "Returns all prefix mapping pairs as a dict")
+        .def("AddPrefixMappingPair", &This::AddPrefixMappingPair, "Add a prefix mapping pair")
+        .def("RemovePrefixMappingByKey", &This::RemovePrefixMappingByKey, "Remove a prefix mapping pair by key")
+        .def("ClearPrefixMappingPairs", &This::ClearPrefixMappingPairs, "Clear all prefix mapping pairs")
+        .def("GetIdentifierTemplates", _GetIdentifierTemplates, "Returns all identifier templates as a list of (regex, format) tuples in priority order")
+        .def("AddIdentifierTemplate", &This::AddIdentifierTemplate, "Add an identifier template (regex, format), returns False if the regex is invalid")
+        .def("ClearIdentifierTemplates", &This::ClearIdentifierTemplates, "Clear all identifier templates")
+        .def("GetResolveRules", _GetResolveRules, "Returns all resolve rules as a list of (regex, format) tuples in priority order")
+        .def("AddResolveRule", &This::AddResolveRule, "Add a resolve rule (regex, format), returns False if the regex is invalid")
+        .def("ClearResolveRules", &This::ClearResolveRules, "Clear all resolve rules")
+        .def("ResolveLatestVersion", &This::ResolveLatestVersion, "Returns the file path with the highest version for a file path pattern with a {latest} version placeholder in the file name (e.g. '/assets/assetA/assetA_v{latest}.usd'), or an empty string if no version exists")
         .def("GetCachingPairs", &This::GetCachingPairs, return_value_policy<return_by_value>(), "Returns all caching pairs as a dict")
         .def("AddCachingPair", &This::AddCachingPair, "Add a caching pair")
         .def("RemoveCachingByKey", &This::RemoveCachingByKey, "Remove a caching pair by key")
         .def("RemoveCachingByValue", &This::RemoveCachingByValue, "Remove a caching pair by value")
         .def("ClearCachingPairs", &This::ClearCachingPairs, "Clear all caching pairs")
+        .def("GetQueryStatistics", GetPythonDict<&This::GetQueryStatistics>, "Returns the Python query count, the de-duplicated (waited on) query count and the accumulated lock wait time in seconds as a dict")
+        .def("ResetQueryStatistics", &This::ResetQueryStatistics, "Reset the query statistics")
+        .def("SaveSnapshot", &This::SaveSnapshot, "Persist the mapping and caching pairs to the snapshot directory, returns False if snapshots are disabled or the write failed")
+        .def("FlushSnapshot", &This::FlushSnapshot, "Persist the snapshot if caching pairs were added since it was written, returns False if there was nothing to flush, the mapping data was edited or the mapping file changed")
     ;
     ArWrapResolverContextForPython<This>();
 }
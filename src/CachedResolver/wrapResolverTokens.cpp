@@ -37,4 +37,8 @@ void wrapResolverTokens()
     class_<CachedResolverTokensType, AR_BOOST_NAMESPACE::noncopyable>
         cls("Tokens", no_init);
     _AddToken(cls, "mappingPairs", CachedResolverTokens->mappingPairs);
+    _AddToken(cls, "cachingPairs", CachedResolverTokens->cachingPairs);
+    _AddToken(cls, "prefixMappingPairs", CachedResolverTokens->prefixMappingPairs);
+    _AddToken(cls, "identifierTemplates", CachedResolverTokens->identifierTemplates);
+    _AddToken(cls, "resolveRules", CachedResolverTokens->resolveRules);
 }
\ No newline at end of file
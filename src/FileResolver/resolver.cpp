@@ -1,8 +1,12 @@
+#define CONVERT_STRING(string) #string
+#define DEFINE_STRING(string) CONVERT_STRING(string)
+
 #include "resolver.h"
 #include "resolverContext.h"
 
 #include "pxr/base/arch/systemInfo.h"
 #include "pxr/base/tf/fileUtils.h"
+#include "pxr/base/tf/getenv.h"
 #include "pxr/base/tf/pathUtils.h"
 #include "pxr/base/tf/pyInvoke.h"
 #include "pxr/base/tf/staticTokens.h"
@@ -11,11 +15,13 @@
 #include "pxr/usd/ar/filesystemWritableAsset.h"
 #include "pxr/usd/ar/notice.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
 #include <regex>
+#include <vector>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -57,22 +63,155 @@ _AnchorRelativePath(
     return TfNormPath(anchoredPath);
 }
 
+static bool
+_ExistsAnchored(
+    const std::string& anchorPath,
+    const std::string& path)
+{
+    bool exists = false;
+    // Search path lookups are answered by the directory index (if enabled) instead of a stat.
+    if (anchorPath.empty() || !DirectoryIndex::GetInstance().Lookup(anchorPath, path, &exists)) {
+        FileResolverStatistics::Add(ResolverStatistic::StatCallCount);
+        exists = TfPathExists(anchorPath.empty() ? path : TfStringCatPaths(anchorPath, path));
+    }
+    return exists;
+}
+
+static ArResolvedPath
+_GetAnchoredResolvedPath(
+    const std::string& anchorPath,
+    const std::string& path)
+{
+    ArResolvedPath absResolvedPath(TfAbsPath(anchorPath.empty() ? path : TfStringCatPaths(anchorPath, path)));
+    // Warm up the page cache for the (likely) following _OpenAsset call.
+    ReadAheadPool::GetInstance().Prefetch(absResolvedPath.GetPathString());
+    return absResolvedPath;
+}
+
 static ArResolvedPath
 _ResolveAnchored(
     const std::string& anchorPath,
     const std::string& path)
 {
-    std::string resolvedPath = path;
-    if (!anchorPath.empty()) {
-        resolvedPath = TfStringCatPaths(anchorPath, path);
+    if (!_ExistsAnchored(anchorPath, path)) {
+        return ArResolvedPath();
+    }
+    return _GetAnchoredResolvedPath(anchorPath, path);
+}
+
+static ArResolvedPath
+_ResolveSearchPaths(
+    const std::vector<std::string>& searchPaths,
+    const std::string& path,
+    bool* isDegraded)
+{
+    *isDegraded = false;
+    SearchPathProber& prober = SearchPathProber::GetInstance();
+    // Probing a single search path concurrently only adds overhead.
+    if (prober.IsEnabled() && searchPaths.size() > 1) {
+        const int searchPathIndex = prober.Probe(searchPaths, [path](const std::string& searchPath){
+            return _ExistsAnchored(searchPath, path);
+        }, isDegraded);
+        if (searchPathIndex < 0) {
+            return ArResolvedPath();
+        }
+        return _GetAnchoredResolvedPath(searchPaths[searchPathIndex], path);
     }
-    return TfPathExists(resolvedPath) ? ArResolvedPath(TfAbsPath(resolvedPath)) : ArResolvedPath();
+    for (const auto& searchPath : searchPaths) {
+        ArResolvedPath resolvedPath = _ResolveAnchored(searchPath, path);
+        if (resolvedPath) {
+            return resolvedPath;
+        }
+    }
+    return ArResolvedPath();
 }
 
-FileResolver::FileResolver() = default;
+FileResolver::FileResolver()
+{
+    ContextRegistry<FileResolverContext>::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_MAX_ENTRIES), 128), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_STAT_INTERVAL), 1.0));
+    ReadAheadPool::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_THREADS), 0), 0)),
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_MAX_IN_FLIGHT), 64), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_READ_AHEAD_EXPIRATION), 300.0));
+    MappedAssetCache::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_ASSET_CACHE_SIZE), 0), 0)) * 1024 * 1024);
+    DirectoryIndex::GetInstance().Configure(
+        TfGetenvBool(DEFINE_STRING(AR_ENV_DIRECTORY_INDEX), false),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_DIRECTORY_INDEX_STAT_INTERVAL), 1.0));
+    SearchPathProber::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_FILERESOLVER_ENV_SEARCH_PATH_PROBE_THREADS), 0), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_FILERESOLVER_ENV_SEARCH_PATH_PROBE_TIMEOUT), 2.0),
+        TfGetenvDouble(DEFINE_STRING(AR_FILERESOLVER_ENV_SEARCH_PATH_PROBE_QUARANTINE), 60.0));
+}
 
 FileResolver::~FileResolver() = default;
 
+std::map<std::string, double> FileResolver::GetStatistics() const{
+    return FileResolverStatistics::Get();
+}
+
+void FileResolver::ResetStatistics(){
+    FileResolverStatistics::Reset();
+}
+
+std::map<std::string, double> FileResolver::GetReadAheadStatistics() const{
+    return ReadAheadPool::GetInstance().GetStatistics();
+}
+
+void FileResolver::ResetReadAheadStatistics(){
+    ReadAheadPool::GetInstance().ResetStatistics();
+}
+
+std::map<std::string, double> FileResolver::GetAssetCacheStatistics() const{
+    return MappedAssetCache::GetInstance().GetStatistics();
+}
+
+void FileResolver::ClearAssetCache(){
+    MappedAssetCache::GetInstance().Clear();
+}
+
+bool FileResolver::GetDirectoryIndexState() const{
+    return DirectoryIndex::GetInstance().IsEnabled();
+}
+
+void FileResolver::SetDirectoryIndexState(const bool state){
+    DirectoryIndex::GetInstance().SetEnabled(state);
+}
+
+std::map<std::string, double> FileResolver::GetDirectoryIndexStatistics() const{
+    return DirectoryIndex::GetInstance().GetStatistics();
+}
+
+void FileResolver::ClearDirectoryIndex(){
+    DirectoryIndex::GetInstance().Clear();
+}
+
+void FileResolver::ConfigureSearchPathProbe(const int threadCount, const double timeout, const double quarantineDuration){
+    SearchPathProber::GetInstance().Configure(static_cast<size_t>(std::max(threadCount, 0)), timeout, quarantineDuration);
+}
+
+bool FileResolver::GetSearchPathProbeState() const{
+    return SearchPathProber::GetInstance().IsEnabled();
+}
+
+std::map<std::string, double> FileResolver::GetSearchPathProbeStatistics() const{
+    return SearchPathProber::GetInstance().GetStatistics();
+}
+
+std::map<std::string, std::map<std::string, double>> FileResolver::GetSearchPathLatencyStatistics() const{
+    return SearchPathProber::GetInstance().GetSearchPathStatistics();
+}
+
+void FileResolver::ClearSearchPathProbeStatistics(){
+    SearchPathProber::GetInstance().Clear();
+}
+
+void FileResolver::SetSearchPathProbeDelay(const std::string& searchPath, const double delay){
+    SearchPathProber::GetInstance().SetProbeDelay(searchPath, delay);
+}
+
 std::string
 FileResolver::_CreateIdentifier(
     const std::string& assetPath,
@@ -80,6 +219,7 @@ FileResolver::_CreateIdentifier(
 {
     TF_DEBUG(FILERESOLVER_RESOLVER).Msg("Resolver::_CreateIdentifier('%s', '%s')\n",
                                         assetPath.c_str(), anchorAssetPath.GetPathString().c_str());
+    FileResolverStatistics::Add(ResolverStatistic::CreateIdentifierCount);
 
     if (assetPath.empty()) {
         return assetPath;
@@ -89,13 +229,25 @@ FileResolver::_CreateIdentifier(
         return TfNormPath(assetPath);
     }
 
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    std::string identifier;
+    if (currentCache && currentCache->FindIdentifier(assetPath, anchorAssetPath, &identifier)) {
+        FileResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return identifier;
+    }
+
     const std::string anchoredAssetPath = _AnchorRelativePath(anchorAssetPath, assetPath);
 
     if (_IsSearchPath(assetPath) && Resolve(anchoredAssetPath).empty()) {
-        return TfNormPath(assetPath);
+        identifier = TfNormPath(assetPath);
+    } else {
+        identifier = TfNormPath(anchoredAssetPath);
     }
 
-    return TfNormPath(anchoredAssetPath);
+    if (currentCache) {
+        currentCache->AddIdentifier(assetPath, anchorAssetPath, identifier);
+    }
+    return identifier;
 }
 
 std::string
@@ -127,39 +279,65 @@ FileResolver::_Resolve(
     if (assetPath.empty()) {
         return ArResolvedPath();
     }
+    FileResolverStatistics::Add(ResolverStatistic::ResolveCount);
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    ArResolvedPath resolvedPath;
+    if (currentCache && currentCache->FindResolvedPath(assetPath, &resolvedPath)) {
+        FileResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return resolvedPath;
+    }
+    resolvedPath = this->_ResolveNoCache(assetPath);
+    if (currentCache) {
+        currentCache->AddResolvedPath(assetPath, resolvedPath);
+    }
+    return resolvedPath;
+}
+
+ArResolvedPath
+FileResolver::_ResolveNoCache(
+    const std::string& assetPath) const
+{
     if (_IsRelativePath(assetPath)) {
         if (this->_IsContextDependentPath(assetPath)) {
             const FileResolverContext* contexts[2] = {this->_GetCurrentContextPtr(), &_fallbackContext};
             for (const FileResolverContext* ctx : contexts) {
                 if (ctx) {
+                    ArResolvedPath resolvedPath;
+                    uint64_t memoEpoch = 0;
+                    if (ctx->FindResolveMemo(assetPath, &resolvedPath, &memoEpoch)) {
+                        FileResolverStatistics::Add(ResolverStatistic::CacheHitCount);
+                        return resolvedPath;
+                    }
+                    if (ctx->GetResolveMemoState()) {
+                        FileResolverStatistics::Add(ResolverStatistic::CacheMissCount);
+                    }
                     auto &mappingPairs = ctx->GetMappingPairs();
-                    std::string mappedPath = assetPath;
-                    if (!mappingPairs.empty()){
-                        if (!ctx->GetMappingRegexExpressionStr().empty())
-                        {
-                            mappedPath = std::regex_replace(mappedPath,
-                                                            ctx->GetMappingRegexExpression(),
-                                                            ctx->GetMappingRegexFormat());
-                            TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s')"
-                                                                        " - Mapped to '%s' via regex expression '%s' with formatting '%s'\n", 
-                                                                        assetPath.c_str(),
-                                                                        mappedPath.c_str(),
-                                                                        ctx->GetMappingRegexExpressionStr().c_str(),
-                                                                        ctx->GetMappingRegexFormat().c_str());
-                        }
+                    // The regex expression only preformats the path for the mapping pairs lookup,
+                    // the mapping regex rules are also applied without mapping pairs.
+                    std::string mappedPath;
+                    if (ctx->ApplyMappingRegex(assetPath, &mappedPath, !mappingPairs.empty()))
+                    {
+                        TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_Resolve('%s')"
+                                                                    " - Mapped to '%s' via the mapping regex expression/rules\n",
+                                                                    assetPath.c_str(),
+                                                                    mappedPath.c_str());
                     }
                     auto map_find = mappingPairs.find(mappedPath);
                     if(map_find != mappingPairs.end()){
+                        FileResolverStatistics::Add(ResolverStatistic::MappingHitCount);
                         mappedPath = map_find->second;
+                    }else if(ctx->FindPrefixMapping(mappedPath, &mappedPath)){
+                        // Exact mapping pairs have priority over prefix mapping pairs.
+                        FileResolverStatistics::Add(ResolverStatistic::MappingHitCount);
                     }
-                    for (const auto& searchPath : ctx->GetSearchPaths()) {
-                        ArResolvedPath resolvedPath = _ResolveAnchored(searchPath, mappedPath);
-                        if (resolvedPath) {
-                            return resolvedPath;
-                        }
+                    bool isDegraded = false;
+                    resolvedPath = _ResolveSearchPaths(ctx->GetSearchPaths(), mappedPath, &isDegraded);
+                    // Results of timed out/quarantined search paths are only valid until the mount recovers.
+                    if (!isDegraded) {
+                        ctx->AddResolveMemo(assetPath, resolvedPath, memoEpoch);
                     }
                     // Only try the first valid context.
-                    break;
+                    return resolvedPath;
                 }
             }
         }
@@ -207,26 +385,22 @@ FileResolver::_CreateDefaultContextForAsset(
         TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Skipping on same stage\n", assetPath.c_str());
         return ArResolverContext(_fallbackContext);
     }
-    auto map_iter = _sharedContexts.find(resolvedPath);
-    if(map_iter != _sharedContexts.end()){
-        if (map_iter->second.timestamp.GetTime() == this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime())
-        {
-            TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage\n", assetPath.c_str());
-            return ArResolverContext(map_iter->second.ctx);
-        }else{
+    // Reuse the context of this mapping file across stages (or create it).
+    FileResolverContext ctx = ContextRegistry<FileResolverContext>::GetInstance().FindOrCreate(
+        resolvedPathStr,
+        [&](){
+            return this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime();
+        },
+        [&](){
+            TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
+            FileResolverStatistics::Add(ResolverStatistic::ContextCreationCount);
+            return FileResolverContext(resolvedPath, std::vector<std::string>(1, TfGetPathName(TfAbsPath(resolvedPathStr))));
+        },
+        [&](FileResolverContext& staleCtx){
             TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage, reloading due to changed timestamp\n", assetPath.c_str());
-            map_iter->second.ctx.RefreshFromMappingFilePath();
-            return ArResolverContext(map_iter->second.ctx);
-        }
-    }
-    // Create new context
-    TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
-    std::string assetDir = TfGetPathName(TfAbsPath(resolvedPathStr));
-    struct FileResolverContextRecord record;
-    record.timestamp = this->_GetModificationTimestamp(assetPath, resolvedPath);
-    record.ctx = FileResolverContext(resolvedPath, std::vector<std::string>(1, assetDir));
-    _sharedContexts.insert(std::pair<std::string, FileResolverContextRecord>(resolvedPath, record));
-    return ArResolverContext(record.ctx);
+            staleCtx.RefreshFromMappingFilePath();
+        });
+    return ArResolverContext(ctx);
 }
 
 bool
@@ -246,9 +420,27 @@ FileResolver::_RefreshContext(
     if (!ctx) {
         return;
     }
+    // Reloads should pick up files that were added/removed on disk.
+    ctx->ClearResolveMemo();
     ArNotice::ResolverChanged(*ctx).Send();
 }
 
+void
+FileResolver::_BeginCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(FILERESOLVER_RESOLVER).Msg("Resolver::_BeginCacheScope()\n");
+    _threadCache.BeginCacheScope(cacheScopeData);
+}
+
+void
+FileResolver::_EndCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(FILERESOLVER_RESOLVER).Msg("Resolver::_EndCacheScope()\n");
+    _threadCache.EndCacheScope(cacheScopeData);
+}
+
 ArTimestamp
 FileResolver::_GetModificationTimestamp(
     const std::string& assetPath,
@@ -257,7 +449,18 @@ FileResolver::_GetModificationTimestamp(
     TF_DEBUG(FILERESOLVER_RESOLVER).Msg(
         "Resolver::GetModificationTimestamp('%s', '%s')\n",
         assetPath.c_str(), resolvedPath.GetPathString().c_str());
-    return ArFilesystemAsset::GetModificationTimestamp(resolvedPath);
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    ArTimestamp timestamp;
+    if (currentCache && currentCache->FindModificationTimestamp(resolvedPath, &timestamp)) {
+        FileResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return timestamp;
+    }
+    FileResolverStatistics::Add(ResolverStatistic::StatCallCount);
+    timestamp = ArFilesystemAsset::GetModificationTimestamp(resolvedPath);
+    if (currentCache) {
+        currentCache->AddModificationTimestamp(resolvedPath, timestamp);
+    }
+    return timestamp;
 }
 
 std::shared_ptr<ArAsset>
@@ -267,6 +470,11 @@ FileResolver::_OpenAsset(
     TF_DEBUG(FILERESOLVER_RESOLVER).Msg(
         "Resolver::OpenAsset('%s')\n",
         resolvedPath.GetPathString().c_str());
+    ReadAheadPool::GetInstance().NotifyOpen(resolvedPath.GetPathString());
+    // Share a single memory mapping per file across all stages, if the asset cache is enabled.
+    if (std::shared_ptr<ArAsset> asset = MappedAssetCache::GetInstance().Open(resolvedPath.GetPathString())) {
+        return asset;
+    }
     return ArFilesystemAsset::Open(resolvedPath);
 }
 
@@ -5,23 +5,24 @@
 #include "debugCodes.h"
 #include "resolverContext.h"
 
+#include "context_registry.h"
+#include "directory_index.h"
+#include "mapped_asset_cache.h"
+#include "read_ahead_pool.h"
+#include "scoped_resolve_cache.h"
+#include "search_path_prober.h"
+
 #include "pxr/pxr.h"
 #include "pxr/usd/ar/resolver.h"
+#include "pxr/usd/ar/threadLocalScopedCache.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <map>
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-struct FileResolverContextRecord
-{
-    ArTimestamp timestamp;
-    FileResolverContext ctx;
-};
-
-static std::map<std::string, FileResolverContextRecord> _sharedContexts;
-
 class FileResolver final : public ArResolver
 {
 public:
@@ -31,6 +32,41 @@ public:
     AR_FILERESOLVER_API
     virtual ~FileResolver();
 
+    // These are defined in the resolver library, so that the Python bindings don't
+    // get their own copy of the (header only) process wide statistics and singletons.
+    AR_FILERESOLVER_API
+    std::map<std::string, double> GetStatistics() const;
+    AR_FILERESOLVER_API
+    void ResetStatistics();
+    AR_FILERESOLVER_API
+    std::map<std::string, double> GetReadAheadStatistics() const;
+    AR_FILERESOLVER_API
+    void ResetReadAheadStatistics();
+    AR_FILERESOLVER_API
+    std::map<std::string, double> GetAssetCacheStatistics() const;
+    AR_FILERESOLVER_API
+    void ClearAssetCache();
+    AR_FILERESOLVER_API
+    bool GetDirectoryIndexState() const;
+    AR_FILERESOLVER_API
+    void SetDirectoryIndexState(const bool state);
+    AR_FILERESOLVER_API
+    std::map<std::string, double> GetDirectoryIndexStatistics() const;
+    AR_FILERESOLVER_API
+    void ClearDirectoryIndex();
+    AR_FILERESOLVER_API
+    void ConfigureSearchPathProbe(const int threadCount, const double timeout, const double quarantineDuration);
+    AR_FILERESOLVER_API
+    bool GetSearchPathProbeState() const;
+    AR_FILERESOLVER_API
+    std::map<std::string, double> GetSearchPathProbeStatistics() const;
+    AR_FILERESOLVER_API
+    std::map<std::string, std::map<std::string, double>> GetSearchPathLatencyStatistics() const;
+    AR_FILERESOLVER_API
+    void ClearSearchPathProbeStatistics();
+    AR_FILERESOLVER_API
+    void SetSearchPathProbeDelay(const std::string& searchPath, const double delay);
+
 protected:
     AR_FILERESOLVER_API
     std::string _CreateIdentifier(
@@ -78,8 +114,20 @@ protected:
     std::shared_ptr<ArWritableAsset> _OpenAssetForWrite(
         const ArResolvedPath& resolvedPath,
         WriteMode writeMode) const final;
+
+    AR_FILERESOLVER_API
+    void _BeginCacheScope(
+        VtValue* cacheScopeData) final;
+
+    AR_FILERESOLVER_API
+    void _EndCacheScope(
+        VtValue* cacheScopeData) final;
     
 private:
+    using _ThreadLocalScopedCache = ArThreadLocalScopedCache<ScopedResolveCache>;
+    mutable _ThreadLocalScopedCache _threadCache;
+    ArResolvedPath _ResolveNoCache(
+        const std::string& assetPath) const;
     const FileResolverContext* _GetCurrentContextPtr() const;
     FileResolverContext _fallbackContext;
 };
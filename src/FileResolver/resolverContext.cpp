@@ -9,6 +9,8 @@
 #include "pxr/base/tf/pathUtils.h"
 #include <pxr/usd/sdf/layer.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -42,6 +44,7 @@ bool getStringEndswithStrings(const std::string &value, const std::vector<std::s
 FileResolverContext::FileResolverContext() {
     // Init
     this->_LoadEnvMappingRegex();
+    this->_LoadEnvResolveMemo();
     this->RefreshSearchPaths();
 }
 
@@ -52,6 +55,7 @@ FileResolverContext::FileResolverContext(const std::string& mappingFilePath)
     TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolverContext('%s') - Creating new context\n", mappingFilePath.c_str());
     // Init
     this->_LoadEnvMappingRegex();
+    this->_LoadEnvResolveMemo();
     this->RefreshSearchPaths();
     this->SetMappingFilePath(TfAbsPath(mappingFilePath));
     this->_GetMappingPairsFromUsdFile(this->GetMappingFilePath());
@@ -62,6 +66,7 @@ FileResolverContext::FileResolverContext(const std::vector<std::string>& searchP
     TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolverContext() - Creating new context with custom search paths\n");
     // Init
     this->_LoadEnvMappingRegex();
+    this->_LoadEnvResolveMemo();
     this->SetCustomSearchPaths(searchPaths);
     this->RefreshSearchPaths();
 }
@@ -71,6 +76,7 @@ FileResolverContext::FileResolverContext(const std::string& mappingFilePath, con
     TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::ResolverContext('%s') - Creating new context with custom search paths\n", mappingFilePath.c_str());
     // Init
     this->_LoadEnvMappingRegex();
+    this->_LoadEnvResolveMemo();
     this->SetCustomSearchPaths(searchPaths);
     this->RefreshSearchPaths();
     this->SetMappingFilePath(TfAbsPath(mappingFilePath));
@@ -108,10 +114,18 @@ void
 FileResolverContext::_LoadEnvMappingRegex()
 {
     data->mappingRegexExpressionStr = TfGetenv(DEFINE_STRING(AR_ENV_SEARCH_REGEX_EXPRESSION));
+    data->mappingRegexExpressionLiteral = PatternRules::GetRequiredLiteral(data->mappingRegexExpressionStr);
     data->mappingRegexExpression = std::regex(data->mappingRegexExpressionStr);
     data->mappingRegexFormat = TfGetenv(DEFINE_STRING(AR_ENV_SEARCH_REGEX_FORMAT));
 }
 
+void
+FileResolverContext::_LoadEnvResolveMemo()
+{
+    data->isResolveMemoEnabled = TfGetenvBool(DEFINE_STRING(AR_FILERESOLVER_ENV_RESOLVE_MEMO), false);
+    data->resolveMemoInterval = TfGetenvDouble(DEFINE_STRING(AR_FILERESOLVER_ENV_RESOLVE_MEMO_INTERVAL), 0.0);
+}
+
 void
 FileResolverContext::_LoadEnvSearchPaths()
 {
@@ -133,30 +147,81 @@ FileResolverContext::_LoadEnvSearchPaths()
     }
 }
 
+static bool
+_GetPairsFromLayerData(const VtDictionary& layerMetaData, const TfToken& key, VtStringArray* pairs)
+{
+    auto pairsDataPtr = layerMetaData.GetValueAtPath(key);
+    if (!pairsDataPtr || !pairsDataPtr->IsHolding<VtStringArray>()){
+        return false;
+    }
+    // This only shares the (copy on write) array data, the strings don't get copied.
+    *pairs = pairsDataPtr->UncheckedGet<VtStringArray>();
+    return pairs->size() % 2 == 0;
+}
+
+static SdfLayerRefPtr
+_OpenMappingLayer(const std::string& filePath)
+{
+    // Re-use the layer if it is already open (e.g. as the root layer of the stage),
+    // otherwise we only need the layer metadata and can skip parsing the prims.
+    if (SdfLayer::Find(filePath)){
+        return SdfLayer::FindOrOpen(filePath);
+    }
+    return SdfLayer::OpenAsAnonymous(filePath, true);
+}
+
 bool FileResolverContext::_GetMappingPairsFromUsdFile(const std::string& filePath)
 {
     data->mappingPairs.clear();
+    data->prefixMappingPairs.Clear();
+    data->mappingRegexRules.Clear();
+    this->ClearResolveMemo();
     std::vector<std::string> usdFilePathExts{ ".usd", ".usdc", ".usda" };
     if (!getStringEndswithStrings(filePath, usdFilePathExts))
     {
         return false;
     }
-    auto layer = SdfLayer::FindOrOpen(TfAbsPath(filePath));
+    auto layer = _OpenMappingLayer(TfAbsPath(filePath));
     if (!layer){
         return false;
     }
     auto layerMetaData = layer->GetCustomLayerData();
-    auto mappingDataPtr = layerMetaData.GetValueAtPath(FileResolverTokens->mappingPairs);
-    if (!mappingDataPtr){
-        return false;
+    pxr::VtStringArray prefixMappingDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, FileResolverTokens->prefixMappingPairs, &prefixMappingDataArray)){
+        for (size_t i = 0; i < prefixMappingDataArray.size(); i+=2) {
+            this->AddPrefixMappingPair(prefixMappingDataArray[i], prefixMappingDataArray[i+1]);
+        }
     }
-    pxr::VtStringArray mappingDataArray = mappingDataPtr->Get<pxr::VtStringArray>();
-    if (mappingDataArray.size() % 2 != 0){
+    pxr::VtStringArray mappingRegexRuleDataArray;
+    if (_GetPairsFromLayerData(layerMetaData, FileResolverTokens->mappingRegexRules, &mappingRegexRuleDataArray)){
+        for (size_t i = 0; i < mappingRegexRuleDataArray.size(); i+=2) {
+            this->AddMappingRegexRule(mappingRegexRuleDataArray[i], mappingRegexRuleDataArray[i+1]);
+        }
+    }
+    pxr::VtStringArray mappingDataArray;
+    if (!_GetPairsFromLayerData(layerMetaData, FileResolverTokens->mappingPairs, &mappingDataArray)){
         return false;
     }
+    // Instead of adding the pairs one by one (a tree search + node allocation per pair),
+    // we sort them once and build the map from the sorted range, where each insert with
+    // an end hint is amortized constant. On duplicate keys the last pair wins, same as AddMappingPair.
+    std::vector<std::pair<std::string, std::string>> mappingPairs;
+    mappingPairs.reserve(mappingDataArray.size() / 2);
     for (size_t i = 0; i < mappingDataArray.size(); i+=2) {
-        this->AddMappingPair(mappingDataArray[i], mappingDataArray[i+1]);
+        mappingPairs.emplace_back(mappingDataArray[i], mappingDataArray[i+1]);
+    }
+    auto compareKeys = [](const std::pair<std::string, std::string>& a, const std::pair<std::string, std::string>& b){
+        return a.first < b.first;
+    };
+    std::stable_sort(mappingPairs.begin(), mappingPairs.end(), compareKeys);
+    for (size_t i = 0; i < mappingPairs.size(); i++) {
+        if (i + 1 < mappingPairs.size() && mappingPairs[i + 1].first == mappingPairs[i].first) {
+            continue;
+        }
+        data->mappingPairs.emplace_hint(data->mappingPairs.end(), std::move(mappingPairs[i].first), std::move(mappingPairs[i].second));
     }
+    TF_DEBUG(FILERESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::_GetMappingPairsFromUsdFile('%s') - Loaded %zu mapping pairs\n",
+                                                filePath.c_str(), data->mappingPairs.size());
     return true;
 }
 
@@ -167,6 +232,7 @@ void FileResolverContext::AddMappingPair(const std::string& sourceStr, const std
     }else{
         data->mappingPairs.insert(std::pair<std::string, std::string>(sourceStr,targetStr));
     }
+    this->ClearResolveMemo();
 }
 
 void FileResolverContext::RemoveMappingByKey(const std::string& sourceStr){
@@ -174,6 +240,7 @@ void FileResolverContext::RemoveMappingByKey(const std::string& sourceStr){
     if (it != data->mappingPairs.end()){
         data->mappingPairs.erase(it);
     }
+    this->ClearResolveMemo();
 }
 
 void FileResolverContext::RemoveMappingByValue(const std::string& targetStr){
@@ -188,6 +255,75 @@ void FileResolverContext::RemoveMappingByValue(const std::string& targetStr){
             ++it;
         }
     }
+    this->ClearResolveMemo();
+}
+
+void FileResolverContext::AddPrefixMappingPair(const std::string& sourcePrefixStr, const std::string& targetPrefixStr){
+    if (sourcePrefixStr.empty()){
+        TF_WARN("Skipping prefix mapping pair with an empty source prefix to '%s'", targetPrefixStr.c_str());
+        return;
+    }
+    data->prefixMappingPairs.InsertOrAssign(sourcePrefixStr, targetPrefixStr);
+    this->ClearResolveMemo();
+}
+
+void FileResolverContext::RemovePrefixMappingByKey(const std::string& sourcePrefixStr){
+    data->prefixMappingPairs.Erase(sourcePrefixStr);
+    this->ClearResolveMemo();
+}
+
+const std::map<std::string, std::string> FileResolverContext::GetPrefixMappingPairs() const{
+    std::map<std::string, std::string> prefixMappingPairs;
+    data->prefixMappingPairs.ForEach([&prefixMappingPairs](const std::string& key, const std::string& value){
+        prefixMappingPairs.emplace(key, value);
+    });
+    return prefixMappingPairs;
+}
+
+bool FileResolverContext::FindPrefixMapping(const std::string& sourceStr, std::string* targetStr) const{
+    const std::string* targetPrefixStr;
+    size_t sourcePrefixSize;
+    if (!data->prefixMappingPairs.FindLongestPrefix(sourceStr, &targetPrefixStr, &sourcePrefixSize)){
+        return false;
+    }
+    *targetStr = *targetPrefixStr + sourceStr.substr(sourcePrefixSize);
+    return true;
+}
+
+bool FileResolverContext::AddMappingRegexRule(const std::string& regexExpressionStr, const std::string& formatStr){
+    std::string errorMsg;
+    if (!data->mappingRegexRules.Add(regexExpressionStr, formatStr, &errorMsg)){
+        TF_WARN("Skipping invalid mapping regex rule '%s': %s", regexExpressionStr.c_str(), errorMsg.c_str());
+        return false;
+    }
+    this->ClearResolveMemo();
+    return true;
+}
+
+const std::vector<std::pair<std::string, std::string>> FileResolverContext::GetMappingRegexRules() const{
+    return data->mappingRegexRules.Get();
+}
+
+void FileResolverContext::ClearMappingRegexRules(){
+    data->mappingRegexRules.Clear();
+    this->ClearResolveMemo();
+}
+
+bool FileResolverContext::ApplyMappingRegex(const std::string& assetPath, std::string* mappedPath, bool applyRegexExpression) const{
+    bool isMapped = false;
+    *mappedPath = assetPath;
+    // Asset paths without the literal of the expression can't match, so we can skip the regex.
+    if (applyRegexExpression && !data->mappingRegexExpressionStr.empty() &&
+        mappedPath->find(data->mappingRegexExpressionLiteral) != std::string::npos){
+        *mappedPath = std::regex_replace(*mappedPath, data->mappingRegexExpression, data->mappingRegexFormat);
+        isMapped = true;
+    }
+    std::string ruleMappedPath;
+    if (data->mappingRegexRules.Replace(*mappedPath, &ruleMappedPath)){
+        *mappedPath = std::move(ruleMappedPath);
+        isMapped = true;
+    }
+    return isMapped;
 }
 
 void FileResolverContext::RefreshSearchPaths(){
@@ -199,6 +335,7 @@ void FileResolverContext::RefreshSearchPaths(){
     if (!data->customSearchPaths.empty()) {
         data->searchPaths.insert(data->searchPaths.end(), data->customSearchPaths.begin(), data->customSearchPaths.end());
     }
+    this->ClearResolveMemo();
 }
 
 void FileResolverContext::SetCustomSearchPaths(const std::vector<std::string>& searchPaths){
@@ -222,3 +359,47 @@ void FileResolverContext::RefreshFromMappingFilePath(){
     this->_GetMappingPairsFromUsdFile(this->GetMappingFilePath());
 }
 
+static double
+_GetCurrentTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FileResolverContext::SetResolveMemoState(const bool state){
+    data->isResolveMemoEnabled = state;
+    this->ClearResolveMemo();
+}
+
+bool FileResolverContext::FindResolveMemo(const std::string& assetPath, ArResolvedPath* resolvedPath, uint64_t* epoch) const{
+    // The epoch is returned on misses, so that results resolved against an
+    // outdated context state don't get memoized by AddResolveMemo.
+    *epoch = data->resolveMemoEpoch;
+    if (!data->isResolveMemoEnabled){
+        return false;
+    }
+    FileResolverContextMemoEntryPtr entry;
+    if (!data->resolveMemo.Find(assetPath, &entry) || entry->epoch != *epoch){
+        return false;
+    }
+    if (data->resolveMemoInterval > 0.0 && _GetCurrentTime() - entry->validationTime >= data->resolveMemoInterval){
+        return false;
+    }
+    *resolvedPath = entry->resolvedPath;
+    return true;
+}
+
+void FileResolverContext::AddResolveMemo(const std::string& assetPath, const ArResolvedPath& resolvedPath, uint64_t epoch) const{
+    if (!data->isResolveMemoEnabled || epoch != data->resolveMemoEpoch){
+        return;
+    }
+    auto entry = std::make_shared<FileResolverContextMemoEntry>();
+    entry->resolvedPath = resolvedPath;
+    entry->validationTime = _GetCurrentTime();
+    entry->epoch = epoch;
+    data->resolveMemo.InsertOrAssign(assetPath, entry);
+}
+
+void FileResolverContext::ClearResolveMemo() const{
+    ++data->resolveMemoEpoch;
+    data->resolveMemo.Clear();
+}
@@ -1,18 +1,26 @@
 #ifndef AR_FILERESOLVER_RESOLVER_CONTEXT_H
 #define AR_FILERESOLVER_RESOLVER_CONTEXT_H
 
+#include <atomic>
 #include <memory>
 #include <regex>
 #include <string>
 #include <map>
+#include <vector>
 
 #include "pxr/pxr.h"
 #include "pxr/usd/ar/defineResolverContext.h"
+#include "pxr/usd/ar/resolvedPath.h"
 #include "pxr/usd/ar/resolverContext.h"
 
 #include "api.h"
 #include "debugCodes.h"
 
+#include "concurrent_string_map.h"
+#include "pattern_rules.h"
+#include "prefix_trie.h"
+#include "resolver_statistics.h"
+
 /* Data Model
 We use an internal data struct that is accessed via a shared pointer
 as Usd currently creates resolver context copies when exposed via python
@@ -20,7 +28,22 @@ instead of passing thru the pointer. This way we can send
 > ArNotice::ResolverChanged(*ctx).Send();
 notifications to the stages.
 > See for more info: https://groups.google.com/g/usd-interest/c/9JrXGGbzBnQ/m/_f3oaqBdAwAJ
+Prefix mapping pairs are stored in a radix trie, so that a longest prefix match
+costs O(path length) regardless of how many prefixes are mapped.
+Before the mapping pair lookup, asset paths get preformatted by the mapping regex expression
+and then by the first matching mapping regex rule. Both skip the regex evaluation for asset
+paths that don't contain the literal(s) that any match requires, see PatternRules.
+Search path resolves (hits and misses, misses are stored as empty resolved paths) can be
+memoized per asset path in the resolveMemo map, see FileResolverContextMemoEntry.
 */
+struct FileResolverContextMemoEntry
+{
+    PXR_NS::ArResolvedPath resolvedPath;
+    double validationTime{0.0};
+    uint64_t epoch{0};
+};
+using FileResolverContextMemoEntryPtr = std::shared_ptr<const FileResolverContextMemoEntry>;
+
 struct FileResolverContextInternalData
 {
     std::vector<std::string> searchPaths;
@@ -28,9 +51,18 @@ struct FileResolverContextInternalData
     std::vector<std::string> customSearchPaths;
     std::string mappingFilePath;
     std::map<std::string, std::string> mappingPairs;
+    PrefixTrie<std::string> prefixMappingPairs;
     std::regex mappingRegexExpression;
     std::string mappingRegexExpressionStr;
+    std::string mappingRegexExpressionLiteral;
     std::string mappingRegexFormat;
+    PatternRules mappingRegexRules;
+    // Any edit of the search paths, mapping pairs or regex bumps the epoch,
+    // which invalidates all memoized resolves at once.
+    std::atomic<bool> isResolveMemoEnabled{false};
+    double resolveMemoInterval{0.0};
+    std::atomic<uint64_t> resolveMemoEpoch{0};
+    ConcurrentStringMap<FileResolverContextMemoEntryPtr> resolveMemo;
 };
 
 class FileResolverContext
@@ -59,14 +91,17 @@ public:
     friend size_t hash_value(const FileResolverContext& ctx);
 
     // Methods
+    // Returns true if a copy of this context exists (e.g. bound to a stage).
+    AR_FILERESOLVER_API
+    bool IsShared() const { return data.use_count() > 1; }
     AR_FILERESOLVER_API
-    std::vector<std::string> GetSearchPaths() const { return data->searchPaths; }
+    const std::vector<std::string>& GetSearchPaths() const { return data->searchPaths; }
     AR_FILERESOLVER_API
     void RefreshSearchPaths();
     AR_FILERESOLVER_API
-    std::vector<std::string> GetEnvSearchPaths() const { return data->envSearchPaths; }
+    const std::vector<std::string>& GetEnvSearchPaths() const { return data->envSearchPaths; }
     AR_FILERESOLVER_API
-    std::vector<std::string> GetCustomSearchPaths() const { return data->customSearchPaths; }
+    const std::vector<std::string>& GetCustomSearchPaths() const { return data->customSearchPaths; }
     AR_FILERESOLVER_API
     void SetCustomSearchPaths(const std::vector<std::string>& searchPaths);
 
@@ -85,7 +120,17 @@ public:
     AR_FILERESOLVER_API
     const std::map<std::string, std::string>& GetMappingPairs() const { return data->mappingPairs; }
     AR_FILERESOLVER_API
-    void ClearMappingPairs() { data->mappingPairs.clear(); }
+    void ClearMappingPairs() { data->mappingPairs.clear(); this->ClearResolveMemo(); }
+    AR_FILERESOLVER_API
+    void AddPrefixMappingPair(const std::string& sourcePrefixStr, const std::string& targetPrefixStr);
+    AR_FILERESOLVER_API
+    void RemovePrefixMappingByKey(const std::string& sourcePrefixStr);
+    AR_FILERESOLVER_API
+    const std::map<std::string, std::string> GetPrefixMappingPairs() const;
+    AR_FILERESOLVER_API
+    void ClearPrefixMappingPairs() { data->prefixMappingPairs.Clear(); this->ClearResolveMemo(); }
+    AR_FILERESOLVER_API
+    bool FindPrefixMapping(const std::string& sourceStr, std::string* targetStr) const;
     AR_FILERESOLVER_API
     const std::regex& GetMappingRegexExpression() const { return data->mappingRegexExpression; }
     AR_FILERESOLVER_API
@@ -93,12 +138,36 @@ public:
     AR_FILERESOLVER_API
     void SetMappingRegexExpression(const std::string& mappingRegexExpressionStr) { 
         data->mappingRegexExpressionStr = mappingRegexExpressionStr;
+        data->mappingRegexExpressionLiteral = PatternRules::GetRequiredLiteral(mappingRegexExpressionStr);
         data->mappingRegexExpression = std::regex(mappingRegexExpressionStr);
+        this->ClearResolveMemo();
     }
     AR_FILERESOLVER_API
     const std::string& GetMappingRegexFormat() const { return data->mappingRegexFormat; }
     AR_FILERESOLVER_API
-    void SetMappingRegexFormat(const std::string& mappingRegexFormat) { data->mappingRegexFormat = mappingRegexFormat; }
+    void SetMappingRegexFormat(const std::string& mappingRegexFormat) { data->mappingRegexFormat = mappingRegexFormat; this->ClearResolveMemo(); }
+
+    AR_FILERESOLVER_API
+    bool AddMappingRegexRule(const std::string& regexExpressionStr, const std::string& formatStr);
+    AR_FILERESOLVER_API
+    const std::vector<std::pair<std::string, std::string>> GetMappingRegexRules() const;
+    AR_FILERESOLVER_API
+    void ClearMappingRegexRules();
+    AR_FILERESOLVER_API
+    bool ApplyMappingRegex(const std::string& assetPath, std::string* mappedPath, bool applyRegexExpression = true) const;
+
+    AR_FILERESOLVER_API
+    bool GetResolveMemoState() const { return data->isResolveMemoEnabled; }
+    AR_FILERESOLVER_API
+    void SetResolveMemoState(const bool state);
+    AR_FILERESOLVER_API
+    bool FindResolveMemo(const std::string& assetPath, PXR_NS::ArResolvedPath* resolvedPath, uint64_t* epoch) const;
+    AR_FILERESOLVER_API
+    void AddResolveMemo(const std::string& assetPath, const PXR_NS::ArResolvedPath& resolvedPath, uint64_t epoch) const;
+    AR_FILERESOLVER_API
+    void ClearResolveMemo() const;
+    AR_FILERESOLVER_API
+    size_t GetResolveMemoSize() const { return data->resolveMemo.Size(); }
 
 private:
     // Vars
@@ -107,10 +176,14 @@ private:
     // Methods
     void _LoadEnvMappingRegex();
     void _LoadEnvSearchPaths();
+    void _LoadEnvResolveMemo();
     bool _GetMappingPairsFromUsdFile(const std::string& filePath);
 
 };
 
+// The statistics are keyed by the context type, so that each resolver plugin gets its own counters.
+using FileResolverStatistics = ResolverStatistics<FileResolverContext>;
+
 PXR_NAMESPACE_OPEN_SCOPE
 AR_DECLARE_RESOLVER_CONTEXT(FileResolverContext);
 PXR_NAMESPACE_CLOSE_SCOPE
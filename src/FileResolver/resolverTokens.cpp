@@ -4,8 +4,12 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 FileResolverTokensType::FileResolverTokensType() :
     mappingPairs("mappingPairs", TfToken::Immortal),
+    prefixMappingPairs("prefixMappingPairs", TfToken::Immortal),
+    mappingRegexRules("mappingRegexRules", TfToken::Immortal),
     allTokens({
-        mappingPairs
+        mappingPairs,
+        prefixMappingPairs,
+        mappingRegexRules
     })
 {
 }
@@ -15,6 +15,8 @@ struct FileResolverTokensType
     AR_FILERESOLVER_API FileResolverTokensType();
 
     const TfToken mappingPairs;
+    const TfToken prefixMappingPairs;
+    const TfToken mappingRegexRules;
     const std::vector<TfToken> allTokens;
 };
 
@@ -1,6 +1,7 @@
 from __future__ import print_function
 import tempfile
 import os
+import time
 import unittest
 
 from pxr import Ar, Sdf, Usd, Vt
@@ -197,11 +198,13 @@ class TestArResolver(unittest.TestCase):
             resolver = Ar.GetResolver()
             with Ar.ResolverContextBinder(ctx):
                 with Ar.ResolverScopedCache():
+                    resolver.ResetStatistics()
                     # Resolve
                     self.assertEqual(
                         os.path.abspath(layer_file_path),
                         resolver.Resolve(layer_identifier),
                     )
+                    call_count = resolver.GetStatistics()["statCallCount"]
                     # Remove file
                     os.remove(layer_file_path)
                     # Query cached result
@@ -209,9 +212,65 @@ class TestArResolver(unittest.TestCase):
                         os.path.abspath(layer_file_path),
                         resolver.Resolve(layer_identifier),
                     )
+                    # Identifiers and modification timestamps are cached as well
+                    anchor_path = Ar.ResolvedPath(os.path.join(temp_dir_path, "anchor.usd"))
+                    identifier = resolver.CreateIdentifier("./other.usd", anchor_path)
+                    self.assertEqual(identifier, resolver.CreateIdentifier("./other.usd", anchor_path))
+                    for _ in range(2):
+                        resolver.GetModificationTimestamp(layer_identifier, Ar.ResolvedPath(layer_file_path))
+                    # Repeated calls in the scope don't hit the file system
+                    statistics = resolver.GetStatistics()
+                    self.assertEqual(statistics["scopedCacheHitCount"], 3)
+                    self.assertEqual(statistics["statCallCount"], call_count + 1)
                 # Uncached result should now return empty result
                 self.assertEqual("", resolver.Resolve(layer_identifier))
 
+    def test_ResolveWithMemo(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths([temp_dir_path])
+            ctx.RefreshSearchPaths()
+            self.assertFalse(ctx.GetResolveMemoState())
+            ctx.SetResolveMemoState(True)
+            # Create files
+            layer_identifier = "layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                resolver.ResetStatistics()
+                # Hits and misses are memoized
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath(layer_file_path))
+                self.assertEqual(resolver.Resolve("new_layer.usd"), Ar.ResolvedPath())
+                self.assertEqual(ctx.GetResolveMemoSize(), 2)
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath(layer_file_path))
+                statistics = resolver.GetStatistics()
+                self.assertEqual(statistics["cacheHitCount"], 1)
+                self.assertEqual(statistics["cacheMissCount"], 2)
+                # Memoized misses stay misses until the memo gets invalidated
+                new_layer_file_path = os.path.join(temp_dir_path, "new_layer.usd")
+                Sdf.Layer.CreateAnonymous().Export(new_layer_file_path)
+                self.assertEqual(resolver.Resolve("new_layer.usd"), Ar.ResolvedPath())
+                ctx.ClearResolveMemo()
+                self.assertEqual(ctx.GetResolveMemoSize(), 0)
+                self.assertEqual(resolver.Resolve("new_layer.usd"), Ar.ResolvedPath(new_layer_file_path))
+                # Context edits invalidate the memo
+                ctx.AddMappingPair(layer_identifier, "new_layer.usd")
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath(new_layer_file_path))
+                ctx.SetCustomSearchPaths([])
+                ctx.RefreshSearchPaths()
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath())
+                # Disabling the memo resolves from disk again
+                ctx.SetResolveMemoState(False)
+                ctx.SetCustomSearchPaths([temp_dir_path])
+                ctx.RefreshSearchPaths()
+                resolver.ResetStatistics()
+                os.remove(new_layer_file_path)
+                self.assertEqual(resolver.Resolve("new_layer.usd"), Ar.ResolvedPath())
+                self.assertEqual(resolver.GetStatistics()["cacheHitCount"], 0)
+
     def test_ResolveWithContext(self):
         with tempfile.TemporaryDirectory() as temp_dir_path:
             # Create context
@@ -270,6 +329,56 @@ class TestArResolver(unittest.TestCase):
                     stage.ResolveIdentifierToEditTarget(layer_a_identifier),
                 )
 
+    def test_ResolveWithPrefixMappingPairs(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_file_paths = {}
+            for identifier in ["pin/assetA_latest/model.usd", "pin/assetA_geo/model.usd", "pin/override.usd"]:
+                layer_file_path = os.path.join(temp_dir_path, identifier)
+                os.makedirs(os.path.dirname(layer_file_path), exist_ok=True)
+                Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+                layer_file_paths[identifier] = layer_file_path
+            # Create context
+            ctx = FileResolver.ResolverContext([temp_dir_path])
+            ctx.AddPrefixMappingPair("assets/assetA/", "pin/assetA_latest/")
+            ctx.AddPrefixMappingPair("assets/assetA/geo/", "pin/assetA_geo/")
+            self.assertEqual(
+                ctx.GetPrefixMappingPairs(),
+                {
+                    "assets/assetA/": "pin/assetA_latest/",
+                    "assets/assetA/geo/": "pin/assetA_geo/",
+                },
+            )
+            # Get resolver
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                # Prefix match
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/model.usd").GetPathString(),
+                    layer_file_paths["pin/assetA_latest/model.usd"],
+                )
+                # Longest prefix match
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(),
+                    layer_file_paths["pin/assetA_geo/model.usd"],
+                )
+                # Exact mapping pairs have priority
+                ctx.AddMappingPair("assets/assetA/geo/model.usd", "pin/override.usd")
+                self.assertEqual(
+                    resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(),
+                    layer_file_paths["pin/override.usd"],
+                )
+                ctx.RemoveMappingByKey("assets/assetA/geo/model.usd")
+                # Remove/Clear
+                ctx.RemovePrefixMappingByKey("assets/assetA/geo/")
+                self.assertEqual(
+                    ctx.GetPrefixMappingPairs(),
+                    {"assets/assetA/": "pin/assetA_latest/"},
+                )
+                self.assertEqual(resolver.Resolve("assets/assetA/geo/model.usd").GetPathString(), "")
+                ctx.ClearPrefixMappingPairs()
+                self.assertEqual(ctx.GetPrefixMappingPairs(), {})
+
     def test_ResolverContextSearchPaths(self):
         ctx = FileResolver.ResolverContext()
         # The default env search paths are passed in through cmake test env vars
@@ -343,11 +452,14 @@ class TestArResolver(unittest.TestCase):
                 "assets/assetA/assetA.usd": "assets/assetA/assetA_v005.usd",
                 "shots/shotA/shotA_v000.usd": "shots/shotA/shotA_v003.usd",
             }
-            mapping_array = []
+            # Duplicate keys are overridden by later pairs
+            mapping_array = ["assets/assetA/assetA.usd", "assets/assetA/assetA_v001.usd"]
             for source_path, target_path in mapping_pairs.items():
                 mapping_array.extend([source_path, target_path])
+            prefix_mapping_pairs = {"assets/assetB/": "assets/assetB_v002/"}
             mapping_layer.customLayerData = {
-                FileResolver.Tokens.mappingPairs: Vt.StringArray(mapping_array)
+                FileResolver.Tokens.mappingPairs: Vt.StringArray(mapping_array),
+                FileResolver.Tokens.prefixMappingPairs: Vt.StringArray(["assets/assetB/", "assets/assetB_v002/"]),
             }
             mapping_layer.Export(mapping_file_path)
 
@@ -355,6 +467,7 @@ class TestArResolver(unittest.TestCase):
             ctx = FileResolver.ResolverContext(mapping_file_path)
             self.assertEqual(ctx.GetMappingFilePath(), mapping_file_path)
             self.assertEqual(ctx.GetMappingPairs(), mapping_pairs)
+            self.assertEqual(ctx.GetPrefixMappingPairs(), prefix_mapping_pairs)
             # Test mapping add
             mapping_pairs_updated = {k: v for k, v in ctx.GetMappingPairs().items()}
             ctx.AddMappingPair("example/cube", "example/sphere")
@@ -393,6 +506,249 @@ class TestArResolver(unittest.TestCase):
         self.assertEqual(ctx.GetMappingRegexExpression(), "(cube)")
         self.assertEqual(ctx.GetMappingRegexFormat(), "Cube")
 
+    def test_ResolveWithMappingRegexRules(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = "shot_010_layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            asset_identifier = os.path.join("assets", "tree.usd")
+            asset_file_path = os.path.join(temp_dir_path, asset_identifier)
+            os.makedirs(os.path.dirname(asset_file_path))
+            Sdf.Layer.CreateAnonymous().Export(asset_file_path)
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths([temp_dir_path])
+            ctx.RefreshSearchPaths()
+            ctx.SetMappingRegexExpression("")
+            ctx.AddMappingPair("shot_010_layer_v000.usd", layer_identifier)
+            # Add rules
+            self.assertTrue(ctx.AddMappingRegexRule(r"assets/(\w+)_v\d+\.usd", "assets/$1.usd"))
+            self.assertTrue(ctx.AddMappingRegexRule(r"_v\d+\.usd", "_v000.usd"))
+            self.assertFalse(ctx.AddMappingRegexRule("(invalid", ""))
+            self.assertEqual(
+                ctx.GetMappingRegexRules(),
+                [(r"assets/(\w+)_v\d+\.usd", "assets/$1.usd"), (r"_v\d+\.usd", "_v000.usd")],
+            )
+            # Get resolver
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                self.assertEqual(resolver.Resolve("shot_010_layer_v12.usd"), Ar.ResolvedPath(layer_file_path))
+                # The first matching rule wins
+                self.assertEqual(resolver.Resolve("assets/tree_v12.usd"), Ar.ResolvedPath(asset_file_path))
+                self.assertEqual(resolver.Resolve("other.usd"), Ar.ResolvedPath())
+                ctx.ClearMappingRegexRules()
+                self.assertEqual(ctx.GetMappingRegexRules(), [])
+                self.assertEqual(resolver.Resolve("shot_010_layer_v12.usd"), Ar.ResolvedPath())
+
+    def test_ResolveWithMappingRegexWithoutMappingPairs(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = "shot_010_layer_v001.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            rule_layer_identifier = "shot_020_layer_v000.usd"
+            rule_layer_file_path = os.path.join(temp_dir_path, rule_layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(rule_layer_file_path)
+            # Create context (without mapping pairs)
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths([temp_dir_path])
+            ctx.RefreshSearchPaths()
+            # The default regex expression values are passed in through cmake test env vars
+            self.assertEqual(ctx.GetMappingRegexExpression(), "(v\d\d\d)")
+            self.assertEqual(ctx.GetMappingRegexFormat(), "v000")
+            # Get resolver
+            resolver = Ar.GetResolver()
+            with Ar.ResolverContextBinder(ctx):
+                # The regex expression is only applied if the context has mapping pairs
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath(layer_file_path))
+                self.assertEqual(resolver.Resolve("shot_020_layer_v012.usd"), Ar.ResolvedPath())
+                # The mapping regex rules are also applied without mapping pairs
+                self.assertTrue(ctx.AddMappingRegexRule(r"shot_020_layer_v\d+\.usd", rule_layer_identifier))
+                self.assertEqual(resolver.Resolve(layer_identifier), Ar.ResolvedPath(layer_file_path))
+                self.assertEqual(resolver.Resolve("shot_020_layer_v012.usd"), Ar.ResolvedPath(rule_layer_file_path))
+
+
+    def test_ResolverStatistics(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = "layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths([temp_dir_path])
+            ctx.RefreshSearchPaths()
+            ctx.AddMappingPair("mapped.usd", layer_identifier)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            resolver.ResetStatistics()
+            self.assertEqual(resolver.GetStatistics()["resolveCount"], 0)
+            with Ar.ResolverContextBinder(ctx):
+                resolver.Resolve("mapped.usd")
+                resolver.Resolve(layer_identifier)
+            statistics = resolver.GetStatistics()
+            self.assertEqual(statistics["resolveCount"], 2)
+            self.assertEqual(statistics["mappingHitCount"], 1)
+            self.assertGreaterEqual(statistics["statCallCount"], 2)
+            self.assertEqual(statistics["pythonCallCount"], 0)
+            # Reset
+            resolver.ResetStatistics()
+            self.assertEqual(resolver.GetStatistics()["resolveCount"], 0)
+
+    def test_ResolveWithDirectoryIndex(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            layer_identifier = os.path.join("shot", "layer.usd")
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            os.makedirs(os.path.dirname(layer_file_path))
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths([temp_dir_path])
+            ctx.RefreshSearchPaths()
+            # Get resolver
+            resolver = Ar.GetResolver()
+            file_resolver = Ar.GetUnderlyingResolver()
+            file_resolver.SetDirectoryIndexState(True)
+            file_resolver.ClearDirectoryIndex()
+            try:
+                with Ar.ResolverContextBinder(ctx):
+                    resolver.ResetStatistics()
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier), Ar.ResolvedPath(layer_file_path)
+                    )
+                    self.assertEqual(resolver.Resolve(os.path.join("shot", "missing.usd")), Ar.ResolvedPath())
+                    self.assertEqual(resolver.Resolve(os.path.join("missing", "layer.usd")), Ar.ResolvedPath())
+                    # Search path lookups don't stat
+                    self.assertEqual(resolver.GetStatistics()["statCallCount"], 0)
+                    statistics = file_resolver.GetDirectoryIndexStatistics()
+                    self.assertEqual(statistics["lookupCount"], 3)
+                    self.assertEqual(statistics["directoryCount"], 2)
+                    # Files added after the listing was read are found once the index is cleared
+                    new_layer_identifier = os.path.join("shot", "new_layer.usd")
+                    new_layer_file_path = os.path.join(temp_dir_path, new_layer_identifier)
+                    Sdf.Layer.CreateAnonymous().Export(new_layer_file_path)
+                    file_resolver.ClearDirectoryIndex()
+                    self.assertEqual(
+                        resolver.Resolve(new_layer_identifier), Ar.ResolvedPath(new_layer_file_path)
+                    )
+                    # The index can't answer parent directory lookups, these fall back to a stat
+                    resolver.ResetStatistics()
+                    self.assertEqual(
+                        resolver.Resolve(os.path.join("shot", "..", layer_identifier)),
+                        Ar.ResolvedPath(layer_file_path),
+                    )
+                    self.assertEqual(resolver.GetStatistics()["statCallCount"], 1)
+            finally:
+                file_resolver.SetDirectoryIndexState(False)
+                file_resolver.ClearDirectoryIndex()
+
+    def test_ResolveWithSearchPathProbe(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            search_paths = [os.path.join(temp_dir_path, name) for name in ["pathA", "pathB", "pathC"]]
+            layer_identifier = "layer.usd"
+            for search_path in search_paths:
+                os.makedirs(search_path)
+            for search_path in search_paths[1:]:
+                Sdf.Layer.CreateAnonymous().Export(os.path.join(search_path, layer_identifier))
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths(search_paths)
+            ctx.RefreshSearchPaths()
+            # Get resolver
+            resolver = Ar.GetResolver()
+            file_resolver = Ar.GetUnderlyingResolver()
+            file_resolver.ConfigureSearchPathProbe(2, 0.0, 60.0)
+            file_resolver.ClearSearchPathProbeStatistics()
+            try:
+                self.assertTrue(file_resolver.GetSearchPathProbeState())
+                with Ar.ResolverContextBinder(ctx):
+                    # The highest priority search path with the file wins
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier),
+                        Ar.ResolvedPath(os.path.join(search_paths[1], layer_identifier)),
+                    )
+                    self.assertEqual(resolver.Resolve("missing.usd"), Ar.ResolvedPath())
+                    statistics = file_resolver.GetSearchPathProbeStatistics()
+                    self.assertEqual(statistics["probeCount"], 2)
+                    self.assertEqual(statistics["timeoutCount"], 0)
+                    latency_statistics = file_resolver.GetSearchPathLatencyStatistics()
+                    self.assertEqual(sorted(latency_statistics.keys()), sorted(search_paths))
+                    self.assertEqual(latency_statistics[search_paths[0]]["probeCount"], 2)
+                    self.assertEqual(latency_statistics[search_paths[0]]["hitCount"], 0)
+                    self.assertEqual(latency_statistics[search_paths[1]]["hitCount"], 1)
+                    self.assertEqual(latency_statistics[search_paths[1]]["isQuarantined"], 0)
+            finally:
+                file_resolver.ConfigureSearchPathProbe(0, 0.0, 0.0)
+                file_resolver.ClearSearchPathProbeStatistics()
+
+    def test_ResolveWithSearchPathProbeTimeout(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create files
+            search_paths = [os.path.join(temp_dir_path, name) for name in ["pathA", "pathB", "pathC"]]
+            layer_identifier = "layer.usd"
+            for search_path in search_paths:
+                os.makedirs(search_path)
+                Sdf.Layer.CreateAnonymous().Export(os.path.join(search_path, layer_identifier))
+            # Create context
+            ctx = FileResolver.ResolverContext()
+            ctx.SetCustomSearchPaths(search_paths)
+            ctx.RefreshSearchPaths()
+            ctx.SetResolveMemoState(True)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            file_resolver = Ar.GetUnderlyingResolver()
+            file_resolver.ConfigureSearchPathProbe(2, 0.2, 60.0)
+            file_resolver.ClearSearchPathProbeStatistics()
+            try:
+                with Ar.ResolverContextBinder(ctx):
+                    # A hanging search path times out, so the next search path wins
+                    file_resolver.SetSearchPathProbeDelay(search_paths[0], 2.0)
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier),
+                        Ar.ResolvedPath(os.path.join(search_paths[1], layer_identifier)),
+                    )
+                    latency_statistics = file_resolver.GetSearchPathLatencyStatistics()
+                    self.assertEqual(latency_statistics[search_paths[0]]["timeoutCount"], 1)
+                    self.assertEqual(latency_statistics[search_paths[0]]["isQuarantined"], 1)
+                    self.assertEqual(file_resolver.GetSearchPathProbeStatistics()["timeoutCount"], 1)
+                    # Results affected by a timeout/quarantine don't get memoized
+                    self.assertEqual(ctx.GetResolveMemoSize(), 0)
+                    # Quarantined search paths are skipped without waiting on them
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier),
+                        Ar.ResolvedPath(os.path.join(search_paths[1], layer_identifier)),
+                    )
+                    latency_statistics = file_resolver.GetSearchPathLatencyStatistics()
+                    self.assertEqual(latency_statistics[search_paths[0]]["quarantineSkipCount"], 1)
+                    self.assertEqual(latency_statistics[search_paths[0]]["timeoutCount"], 1)
+                    self.assertEqual(ctx.GetResolveMemoSize(), 0)
+                    # Once the quarantine is lifted, the highest priority search path wins again
+                    file_resolver.ClearSearchPathProbeStatistics()
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier),
+                        Ar.ResolvedPath(os.path.join(search_paths[0], layer_identifier)),
+                    )
+                    self.assertEqual(ctx.GetResolveMemoSize(), 1)
+                    # Queued probes of lower priority search paths are cancelled after a higher priority hit
+                    ctx.ClearResolveMemo()
+                    file_resolver.ClearSearchPathProbeStatistics()
+                    file_resolver.ConfigureSearchPathProbe(2, 0.0, 60.0)
+                    file_resolver.SetSearchPathProbeDelay(search_paths[1], 0.5)
+                    self.assertEqual(
+                        resolver.Resolve(layer_identifier),
+                        Ar.ResolvedPath(os.path.join(search_paths[0], layer_identifier)),
+                    )
+                    # The lowest priority probe is only dequeued after the hit (there are at most two workers)
+                    time.sleep(1.0)
+                    self.assertGreaterEqual(file_resolver.GetSearchPathProbeStatistics()["cancelledCount"], 1)
+                    self.assertEqual(file_resolver.GetSearchPathLatencyStatistics()[search_paths[2]]["probeCount"], 0)
+            finally:
+                file_resolver.ConfigureSearchPathProbe(0, 0.0, 0.0)
+                file_resolver.ClearSearchPathProbeStatistics()
+
 
 if __name__ == "__main__":
     unittest.main()
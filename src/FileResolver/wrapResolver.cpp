@@ -4,9 +4,12 @@
 #include <pxr/pxr.h>
 
 #include "boost_include_wrapper.h"
+#include BOOST_INCLUDE(python/args.hpp)
 #include BOOST_INCLUDE(python/class.hpp)
 #include BOOST_INCLUDE(python/return_value_policy.hpp)
 
+#include "python_dict.h"
+
 using namespace AR_BOOST_NAMESPACE::python;
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -18,5 +21,23 @@ wrapResolver()
 
     class_<This, bases<ArResolver>, AR_BOOST_NAMESPACE::noncopyable>
         ("Resolver", no_init)
+        .def("GetStatistics", GetPythonDict<&This::GetStatistics>, "Returns the resolver statistics (operation/cache hit/Python call counts and accumulated Python/lock wait time in seconds) as a dict")
+        .def("ResetStatistics", &This::ResetStatistics, "Reset the resolver statistics")
+        .def("GetReadAheadStatistics", GetPythonDict<&This::GetReadAheadStatistics>, "Returns the read-ahead prefetch/dropped counts and the hit (prefetch finished before open)/late (prefetch still pending on open)/miss (not prefetched) open counts as a dict")
+        .def("ResetReadAheadStatistics", &This::ResetReadAheadStatistics, "Reset the read-ahead statistics")
+        .def("GetAssetCacheStatistics", GetPythonDict<&This::GetAssetCacheStatistics>, "Returns the memory mapped asset cache hit/miss/eviction counts, the cached entry count and the cached bytes as a dict")
+        .def("ClearAssetCache", &This::ClearAssetCache, "Drop all cached memory mapped assets (assets that are still in use stay valid)")
+        .def("GetDirectoryIndexState", &This::GetDirectoryIndexState, "Get the state of answering search path lookups via the directory index")
+        .def("SetDirectoryIndexState", &This::SetDirectoryIndexState, "Set the state of answering search path lookups via the directory index")
+        .def("GetDirectoryIndexStatistics", GetPythonDict<&This::GetDirectoryIndexStatistics>, "Returns the directory index lookup count, the directory stat/listing counts and the indexed directory count as a dict")
+        .def("ClearDirectoryIndex", &This::ClearDirectoryIndex, "Drop all indexed directory listings")
+        .def("ConfigureSearchPathProbe", &This::ConfigureSearchPathProbe,
+             (arg("threadCount"), arg("timeout"), arg("quarantineDuration")),
+             "Configure the concurrent probing of search paths (a thread count of 0 disables it), search paths that don't answer within the timeout (in seconds) are skipped for the quarantine duration (in seconds)")
+        .def("GetSearchPathProbeState", &This::GetSearchPathProbeState, "Get the state of probing search paths concurrently")
+        .def("GetSearchPathProbeStatistics", GetPythonDict<&This::GetSearchPathProbeStatistics>, "Returns the concurrent probe count, the cancelled (skipped after a higher priority hit) probe count and the timed out probe count as a dict")
+        .def("GetSearchPathLatencyStatistics", GetPythonDict<&This::GetSearchPathLatencyStatistics>, "Returns the probe/hit/timeout/quarantine skip counts, the mean/max latency (in seconds) and the quarantine state per search path as a dict of dicts")
+        .def("ClearSearchPathProbeStatistics", &This::ClearSearchPathProbeStatistics, "Reset the search path probe statistics and lift all quarantines/probe delays")
+        .def("SetSearchPathProbeDelay", &This::SetSearchPathProbeDelay, "Delay all probes of the search path by the given seconds, this is only meant for testing slow mounts")
     ;
 }
\ No newline at end of file
@@ -6,8 +6,10 @@
 
 #include "boost_include_wrapper.h"
 #include BOOST_INCLUDE(python/class.hpp)
+#include BOOST_INCLUDE(python/list.hpp)
 #include BOOST_INCLUDE(python/operators.hpp)
 #include BOOST_INCLUDE(python/return_value_policy.hpp)
+#include BOOST_INCLUDE(python/tuple.hpp)
 
 #include <string>
 
@@ -31,6 +33,17 @@ _Repr(const FileResolverContext& ctx)
             "('" + ctx.GetMappingFilePath() + "')");
 }
 
+static
+list
+_GetMappingRegexRules(const FileResolverContext& ctx)
+{
+    list result;
+    for (const auto& it : ctx.GetMappingRegexRules()) {
+        result.append(make_tuple(it.first, it.second));
+    }
+    return result;
+}
+
 void
 wrapResolverContext()
 {
@@ -58,10 +71,21 @@ wrapResolverContext()
         .def("RemoveMappingByKey", &This::RemoveMappingByKey, "Remove a mapping pair by key")
         .def("RemoveMappingByValue", &This::RemoveMappingByValue, "Remove a mapping pair by value")
         .def("ClearMappingPairs", &This::ClearMappingPairs, "Clear all mapping pairs")
+        .def("GetPrefixMappingPairs", &This::GetPrefixMappingPairs, return_value_policy<return_by_value>(), "Returns all prefix mapping pairs as a dict")
+        .def("AddPrefixMappingPair", &This::AddPrefixMappingPair, "Add a prefix mapping pair")
+        .def("RemovePrefixMappingByKey", &This::RemovePrefixMappingByKey, "Remove a prefix mapping pair by key")
+        .def("ClearPrefixMappingPairs", &This::ClearPrefixMappingPairs, "Clear all prefix mapping pairs")
         .def("GetMappingRegexExpression", &This::GetMappingRegexExpressionStr, return_value_policy<return_by_value>(), "Get the regex expression")
         .def("SetMappingRegexExpression", &This::SetMappingRegexExpression, "Set the regex expression")
         .def("GetMappingRegexFormat", &This::GetMappingRegexFormat, return_value_policy<return_by_value>(), "Get the regex expression substitution formatting")
         .def("SetMappingRegexFormat", &This::SetMappingRegexFormat, "Set the regex expression substitution formatting")
+        .def("GetMappingRegexRules", _GetMappingRegexRules, "Returns all mapping regex rules as a list of (regex, format) tuples in priority order")
+        .def("AddMappingRegexRule", &This::AddMappingRegexRule, "Add a mapping regex rule (regex, format), returns False if the regex is invalid")
+        .def("ClearMappingRegexRules", &This::ClearMappingRegexRules, "Clear all mapping regex rules")
+        .def("GetResolveMemoState", &This::GetResolveMemoState, "Get the state of memoizing search path resolves (hits and misses)")
+        .def("SetResolveMemoState", &This::SetResolveMemoState, "Set the state of memoizing search path resolves (hits and misses)")
+        .def("GetResolveMemoSize", &This::GetResolveMemoSize, "Get the number of memoized search path resolves")
+        .def("ClearResolveMemo", &This::ClearResolveMemo, "Clear all memoized search path resolves")
     ;
     ArWrapResolverContextForPython<This>();
 }
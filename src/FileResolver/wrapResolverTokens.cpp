@@ -37,4 +37,6 @@ void wrapResolverTokens()
     class_<FileResolverTokensType, AR_BOOST_NAMESPACE::noncopyable>
         cls("Tokens", no_init);
     _AddToken(cls, "mappingPairs", FileResolverTokens->mappingPairs);
+    _AddToken(cls, "prefixMappingPairs", FileResolverTokens->prefixMappingPairs);
+    _AddToken(cls, "mappingRegexRules", FileResolverTokens->mappingRegexRules);
 }
\ No newline at end of file
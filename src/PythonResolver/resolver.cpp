@@ -6,6 +6,7 @@
 
 #include "pxr/base/arch/systemInfo.h"
 #include "pxr/base/tf/fileUtils.h"
+#include "pxr/base/tf/getenv.h"
 #include "pxr/base/tf/pathUtils.h"
 #include "pxr/base/tf/pyInvoke.h"
 #include "pxr/base/tf/staticTokens.h"
@@ -15,6 +16,9 @@
 #include "pxr/usd/ar/notice.h"
 #include "pxr/usd/ar/timestamp.h"
 
+#include "python_hook.h"
+
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -25,15 +29,65 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 AR_DEFINE_RESOLVER(PythonResolver, ArResolver);
 
-PythonResolver::PythonResolver() = default;
+static const PythonHook g_resolver_create_identifier_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._CreateIdentifier");
+static const PythonHook g_resolver_create_identifier_for_new_asset_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._CreateIdentifierForNewAsset");
+static const PythonHook g_resolver_resolve_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._Resolve");
+static const PythonHook g_resolver_resolve_for_new_asset_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._ResolveForNewAsset");
+static const PythonHook g_resolver_is_context_dependent_path_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._IsContextDependentPath");
+static const PythonHook g_resolver_get_modification_timestamp_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "Resolver._GetModificationTimestamp");
+
+PythonResolver::PythonResolver()
+{
+    ContextRegistry<PythonResolverContext>::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_MAX_ENTRIES), 128), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_CONTEXT_REGISTRY_STAT_INTERVAL), 1.0));
+    ReadAheadPool::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_THREADS), 0), 0)),
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_READ_AHEAD_MAX_IN_FLIGHT), 64), 0)),
+        TfGetenvDouble(DEFINE_STRING(AR_ENV_READ_AHEAD_EXPIRATION), 300.0));
+    MappedAssetCache::GetInstance().Configure(
+        static_cast<size_t>(std::max(TfGetenvInt(DEFINE_STRING(AR_ENV_ASSET_CACHE_SIZE), 0), 0)) * 1024 * 1024);
+}
 
 PythonResolver::~PythonResolver() = default;
 
+std::map<std::string, double> PythonResolver::GetStatistics() const{
+    return PythonResolverStatistics::Get();
+}
+
+void PythonResolver::ResetStatistics(){
+    PythonResolverStatistics::Reset();
+}
+
+std::map<std::string, double> PythonResolver::GetReadAheadStatistics() const{
+    return ReadAheadPool::GetInstance().GetStatistics();
+}
+
+void PythonResolver::ResetReadAheadStatistics(){
+    ReadAheadPool::GetInstance().ResetStatistics();
+}
+
+std::map<std::string, double> PythonResolver::GetAssetCacheStatistics() const{
+    return MappedAssetCache::GetInstance().GetStatistics();
+}
+
+void PythonResolver::ClearAssetCache(){
+    MappedAssetCache::GetInstance().Clear();
+}
+
 std::string
 PythonResolver::_CreateIdentifier(
     const std::string& assetPath,
     const ArResolvedPath& anchorAssetPath) const
 {
+    PythonResolverStatistics::Add(ResolverStatistic::CreateIdentifierCount);
+    // Scope hits skip the context serialization as well as the Python call.
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    std::string pythonResult;
+    if (currentCache && currentCache->FindIdentifier(assetPath, anchorAssetPath, &pythonResult)) {
+        PythonResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return pythonResult;
+    }
     const PythonResolverContext* contexts[2] = {this->_GetCurrentContextPtr(), &_fallbackContext};
     std::string serializedContext = "";
     std::string serializedFallbackContext = _fallbackContext.GetData(); 
@@ -41,13 +95,15 @@ PythonResolver::_CreateIdentifier(
     TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg("Resolver::_CreateIdentifier('%s', '%s', '%s', '%s')\n",
                                           assetPath.c_str(), anchorAssetPath.GetPathString().c_str(),
                                           serializedContext.c_str(), serializedFallbackContext.c_str());
-    std::string pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._CreateIdentifier",
-                                     &pythonResult, assetPath, anchorAssetPath, serializedContext, serializedFallbackContext);
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_create_identifier_hook.CallAndExtract(&pythonResult, assetPath, anchorAssetPath, serializedContext, serializedFallbackContext);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._CreateIdentifier in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
+    } else if (currentCache) {
+        currentCache->AddIdentifier(assetPath, anchorAssetPath, pythonResult);
     }
     return pythonResult;
 }
@@ -61,9 +117,10 @@ PythonResolver::_CreateIdentifierForNewAsset(
         "Resolver::_CreateIdentifierForNewAsset ('%s', '%s')\n",
         assetPath.c_str(), anchorAssetPath.GetPathString().c_str());
     std::string pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._CreateIdentifierForNewAsset",
-                                     &pythonResult, assetPath, anchorAssetPath);
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_create_identifier_for_new_asset_hook.CallAndExtract(&pythonResult, assetPath, anchorAssetPath);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._CreateIdentifierForNewAsset in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
@@ -75,20 +132,31 @@ ArResolvedPath
 PythonResolver::_Resolve(
     const std::string& assetPath) const
 {
+    PythonResolverStatistics::Add(ResolverStatistic::ResolveCount);
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
+    ArResolvedPath pythonResult;
+    if (currentCache && currentCache->FindResolvedPath(assetPath, &pythonResult)) {
+        PythonResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return pythonResult;
+    }
     const PythonResolverContext* contexts[2] = {this->_GetCurrentContextPtr(), &_fallbackContext};
     std::string serializedContext = "";
     std::string serializedFallbackContext = _fallbackContext.GetData(); 
     if (contexts[0] != nullptr){serializedContext=this->_GetCurrentContextPtr()->GetData();}
     TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg("Resolver::_Resolve('%s', '%s', '%s')\n", assetPath.c_str(),
                                           serializedContext.c_str(), serializedFallbackContext.c_str());
-    ArResolvedPath pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._Resolve",
-                                     &pythonResult, assetPath, serializedContext, serializedFallbackContext);
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_resolve_hook.CallAndExtract(&pythonResult, assetPath, serializedContext, serializedFallbackContext);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._Resolve in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
+    } else if (currentCache) {
+        currentCache->AddResolvedPath(assetPath, pythonResult);
     }
+    // Warm up the page cache for the (likely) following _OpenAsset call.
+    ReadAheadPool::GetInstance().Prefetch(pythonResult.GetPathString());
     return pythonResult;
 }
 
@@ -98,9 +166,10 @@ PythonResolver::_ResolveForNewAsset(
 {
     TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg("Resolver::_ResolveForNewAsset('%s')\n", assetPath.c_str());
     ArResolvedPath pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._ResolveForNewAsset",
-                                     &pythonResult, assetPath);
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_resolve_for_new_asset_hook.CallAndExtract(&pythonResult, assetPath);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._ResolveForNewAsset in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
@@ -139,26 +208,22 @@ PythonResolver::_CreateDefaultContextForAsset(
         TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Skipping on same stage\n", assetPath.c_str());
         return ArResolverContext(_fallbackContext);
     }
-    auto map_iter = _sharedContexts.find(resolvedPath);
-    if(map_iter != _sharedContexts.end()){
-        if (map_iter->second.timestamp.GetTime() == this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime())
-        {
-            TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage\n", assetPath.c_str());
-            return ArResolverContext(map_iter->second.ctx);
-        }else{
+    // Reuse the context of this mapping file across stages (or create it).
+    PythonResolverContext ctx = ContextRegistry<PythonResolverContext>::GetInstance().FindOrCreate(
+        resolvedPathStr,
+        [&](){
+            return this->_GetModificationTimestamp(assetPath, resolvedPath).GetTime();
+        },
+        [&](){
+            TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
+            PythonResolverStatistics::Add(ResolverStatistic::ContextCreationCount);
+            return PythonResolverContext(resolvedPath);
+        },
+        [&](PythonResolverContext& staleCtx){
             TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Reusing context on different stage, reloading due to changed timestamp\n", assetPath.c_str());
-            map_iter->second.ctx.LoadOrRefreshData();
-            return ArResolverContext(map_iter->second.ctx);
-        }
-    }
-    // Create new context
-    TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_CreateDefaultContextForAsset('%s') - Constructing new context\n", assetPath.c_str());
-    std::string assetDir = TfGetPathName(TfAbsPath(resolvedPathStr));
-    struct PythonResolverContextRecord record;
-    record.timestamp = this->_GetModificationTimestamp(assetPath, resolvedPath);
-    record.ctx = PythonResolverContext(resolvedPath);
-    _sharedContexts.insert(std::pair<std::string, PythonResolverContextRecord>(resolvedPath, record));
-    return ArResolverContext(record.ctx);
+            staleCtx.LoadOrRefreshData();
+        });
+    return ArResolverContext(ctx);
 }
 
 bool
@@ -167,9 +232,10 @@ PythonResolver::_IsContextDependentPath(
 {
     TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("Resolver::_IsContextDependentPath()\n");
     bool pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._IsContextDependentPath",
-                                     &pythonResult, assetPath);
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_is_context_dependent_path_hook.CallAndExtract(&pythonResult, assetPath);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._IsContextDependentPath in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
@@ -189,6 +255,22 @@ PythonResolver::_RefreshContext(
     ArNotice::ResolverChanged(*ctx).Send();
 }
 
+void
+PythonResolver::_BeginCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg("Resolver::_BeginCacheScope()\n");
+    _threadCache.BeginCacheScope(cacheScopeData);
+}
+
+void
+PythonResolver::_EndCacheScope(
+    VtValue* cacheScopeData)
+{
+    TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg("Resolver::_EndCacheScope()\n");
+    _threadCache.EndCacheScope(cacheScopeData);
+}
+
 ArTimestamp
 PythonResolver::_GetModificationTimestamp(
     const std::string& assetPath,
@@ -197,13 +279,21 @@ PythonResolver::_GetModificationTimestamp(
     TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg(
         "Resolver::GetModificationTimestamp('%s', '%s')\n",
         assetPath.c_str(), resolvedPath.GetPathString().c_str());
+    const _ThreadLocalScopedCache::CachePtr currentCache = _threadCache.GetCurrentCache();
     ArTimestamp pythonResult;
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "Resolver._GetModificationTimestamp",
-                                     &pythonResult, assetPath, resolvedPath);
+    if (currentCache && currentCache->FindModificationTimestamp(resolvedPath, &pythonResult)) {
+        PythonResolverStatistics::Add(ResolverStatistic::ScopedCacheHitCount);
+        return pythonResult;
+    }
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_get_modification_timestamp_hook.CallAndExtract(&pythonResult, assetPath, resolvedPath);
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     if (!state) {
         std::cerr << "Failed to call Resolver._GetModificationTimestamp in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
+    } else if (currentCache) {
+        currentCache->AddModificationTimestamp(resolvedPath, pythonResult);
     }
     return pythonResult;
 }
@@ -215,6 +305,11 @@ PythonResolver::_OpenAsset(
     TF_DEBUG(PYTHONRESOLVER_RESOLVER).Msg(
         "Resolver::OpenAsset('%s')\n",
         resolvedPath.GetPathString().c_str());
+    ReadAheadPool::GetInstance().NotifyOpen(resolvedPath.GetPathString());
+    // Share a single memory mapping per file across all stages, if the asset cache is enabled.
+    if (std::shared_ptr<ArAsset> asset = MappedAssetCache::GetInstance().Open(resolvedPath.GetPathString())) {
+        return asset;
+    }
     return ArFilesystemAsset::Open(resolvedPath);
 }
 
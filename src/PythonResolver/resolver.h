@@ -5,8 +5,14 @@
 #include "debugCodes.h"
 #include "resolverContext.h"
 
+#include "context_registry.h"
+#include "mapped_asset_cache.h"
+#include "read_ahead_pool.h"
+#include "scoped_resolve_cache.h"
+
 #include "pxr/pxr.h"
 #include "pxr/usd/ar/resolver.h"
+#include "pxr/usd/ar/threadLocalScopedCache.h"
 
 #include <memory>
 #include <string>
@@ -14,14 +20,6 @@
 
 PXR_NAMESPACE_OPEN_SCOPE
 
-struct PythonResolverContextRecord
-{
-    ArTimestamp timestamp;
-    PythonResolverContext ctx;
-};
-
-static std::map<std::string, PythonResolverContextRecord> _sharedContexts;
-
 class PythonResolver final : public ArResolver
 {
 public:
@@ -31,6 +29,21 @@ public:
     AR_PYTHONRESOLVER_API
     virtual ~PythonResolver();
 
+    // These are defined in the resolver library, so that the Python bindings don't
+    // get their own copy of the (header only) process wide statistics and singletons.
+    AR_PYTHONRESOLVER_API
+    std::map<std::string, double> GetStatistics() const;
+    AR_PYTHONRESOLVER_API
+    void ResetStatistics();
+    AR_PYTHONRESOLVER_API
+    std::map<std::string, double> GetReadAheadStatistics() const;
+    AR_PYTHONRESOLVER_API
+    void ResetReadAheadStatistics();
+    AR_PYTHONRESOLVER_API
+    std::map<std::string, double> GetAssetCacheStatistics() const;
+    AR_PYTHONRESOLVER_API
+    void ClearAssetCache();
+
 protected:
     AR_PYTHONRESOLVER_API
     std::string _CreateIdentifier(
@@ -78,8 +91,18 @@ protected:
     std::shared_ptr<ArWritableAsset> _OpenAssetForWrite(
         const ArResolvedPath& resolvedPath,
         WriteMode writeMode) const final;
+
+    AR_PYTHONRESOLVER_API
+    void _BeginCacheScope(
+        VtValue* cacheScopeData) final;
+
+    AR_PYTHONRESOLVER_API
+    void _EndCacheScope(
+        VtValue* cacheScopeData) final;
     
 private:
+    using _ThreadLocalScopedCache = ArThreadLocalScopedCache<ScopedResolveCache>;
+    mutable _ThreadLocalScopedCache _threadCache;
     const PythonResolverContext* _GetCurrentContextPtr() const;
     PythonResolverContext _fallbackContext;
 };
@@ -8,10 +8,14 @@
 #include "pxr/base/tf/pathUtils.h"
 #include "pxr/base/tf/pyInvoke.h"
 
+#include "python_hook.h"
+
 #include <iostream>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
+static const PythonHook g_resolver_context_load_or_refresh_data_hook(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME), "ResolverContext.LoadOrRefreshData");
+
 PythonResolverContext::PythonResolverContext() {
     // Init
     this->LoadOrRefreshData();
@@ -59,14 +63,15 @@ size_t hash_value(const PythonResolverContext& ctx)
 void PythonResolverContext::LoadOrRefreshData(){
     TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::LoadOrRefreshData('%s', '%s', '%s', '%s') - Loading data\n", this->GetMappingFilePath().c_str(), DEFINE_STRING(AR_ENV_SEARCH_PATHS), DEFINE_STRING(AR_ENV_SEARCH_REGEX_EXPRESSION), DEFINE_STRING(AR_ENV_SEARCH_REGEX_FORMAT));
     std::string pythonResult;    
-    int state = TfPyInvokeAndExtract(DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME),
-                                     "ResolverContext.LoadOrRefreshData",
-                                     &pythonResult, this->GetMappingFilePath(), DEFINE_STRING(AR_ENV_SEARCH_PATHS),
-                                     DEFINE_STRING(AR_ENV_SEARCH_REGEX_EXPRESSION), DEFINE_STRING(AR_ENV_SEARCH_REGEX_FORMAT));  
+    PythonResolverStatistics::Add(ResolverStatistic::PythonCallCount);
+    const PythonResolverStatistics::Clock::time_point pythonStartTime = PythonResolverStatistics::Clock::now();
+    int state = g_resolver_context_load_or_refresh_data_hook.CallAndExtract(&pythonResult, this->GetMappingFilePath(), DEFINE_STRING(AR_ENV_SEARCH_PATHS),
+                                                                            DEFINE_STRING(AR_ENV_SEARCH_REGEX_EXPRESSION), DEFINE_STRING(AR_ENV_SEARCH_REGEX_FORMAT));
     if (!state) {
         std::cerr << "Failed to call ResolverContext.LoadOrRefreshData in " << DEFINE_STRING(AR_PYTHONRESOLVER_USD_PYTHON_EXPOSE_MODULE_NAME) << ".py. ";
         std::cerr << "Please verify that the python code is valid!" << std::endl;
     }
     TF_DEBUG(PYTHONRESOLVER_RESOLVER_CONTEXT).Msg("ResolverContext::LoadOrRefreshData('%s') - Loaded data '%s'\n", this->GetMappingFilePath().c_str(), pythonResult.c_str());
+    PythonResolverStatistics::AddTime(ResolverStatistic::PythonTime, pythonStartTime);
     this->SetData(pythonResult);
 }
\ No newline at end of file
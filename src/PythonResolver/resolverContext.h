@@ -8,6 +8,8 @@
 #include "pxr/usd/ar/defineResolverContext.h"
 #include "pxr/usd/ar/resolverContext.h"
 
+#include "resolver_statistics.h"
+
 #include <memory>
 #include <regex>
 #include <string>
@@ -43,6 +45,9 @@ public:
     friend size_t hash_value(const PythonResolverContext& ctx);
 
     // Methods
+    // Returns true if a copy of this context exists (e.g. bound to a stage).
+    AR_PYTHONRESOLVER_API
+    bool IsShared() const { return _mappingFilePath.use_count() > 1; }
     AR_PYTHONRESOLVER_API
     const std::string& GetMappingFilePath() const { return *_mappingFilePath;}
     AR_PYTHONRESOLVER_API
@@ -59,6 +64,9 @@ private:
     std::shared_ptr<std::string> _data = std::make_shared<std::string>();
 };
 
+// The statistics are keyed by the context type, so that each resolver plugin gets its own counters.
+using PythonResolverStatistics = ResolverStatistics<PythonResolverContext>;
+
 PXR_NAMESPACE_OPEN_SCOPE
 AR_DECLARE_RESOLVER_CONTEXT(PythonResolverContext);
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,31 @@
+"""Measures the Python hook call overhead, that the Python based resolvers pay on every Python call.
+The PythonResolver calls its PythonExpose hook on every resolve, so the resolve time minus the time
+spent in Python is the per call overhead of the C++ <-> Python round trip.
+Run via ctest (benchmarkPythonResolverHooks) or directly with the pythonResolver on the PYTHONPATH.
+"""
+import sys
+import timeit
+
+from pxr import Ar
+
+
+def main(call_count=100000):
+    Ar.SetPreferredResolver("PythonResolver")
+    resolver = Ar.GetResolver()
+    underlying_resolver = Ar.GetUnderlyingResolver()
+    # An absolute path, so that the hook does as little work as possible.
+    asset_path = "/some/asset.usd"
+    resolver.Resolve(asset_path)
+    underlying_resolver.ResetStatistics()
+    resolve_time = timeit.timeit(lambda: resolver.Resolve(asset_path), number=call_count)
+    statistics = underlying_resolver.GetStatistics()
+    python_call_count = max(statistics["pythonCallCount"], 1)
+    resolve_ns_per_call = resolve_time / call_count * 1e9
+    hook_ns_per_call = statistics["pythonTime"] / python_call_count * 1e9
+    print("Resolve:     {:8.1f} ns/call".format(resolve_ns_per_call))
+    print("PythonHook:  {:8.1f} ns/call".format(hook_ns_per_call))
+    print("Overhead:    {:8.1f} ns/call".format(resolve_ns_per_call - hook_ns_per_call))
+
+
+if __name__ == "__main__":
+    main(int(sys.argv[1]) if len(sys.argv) > 1 else 100000)
@@ -200,11 +200,13 @@ class TestArResolver(unittest.TestCase):
             resolver = Ar.GetResolver()
             with Ar.ResolverContextBinder(ctx):
                 with Ar.ResolverScopedCache():
+                    resolver.ResetStatistics()
                     # Resolve
                     self.assertEqual(
                         os.path.abspath(layer_file_path),
                         resolver.Resolve(layer_identifier),
                     )
+                    call_count = resolver.GetStatistics()["pythonCallCount"]
                     # Remove file
                     os.remove(layer_file_path)
                     # Query cached result
@@ -212,6 +214,16 @@ class TestArResolver(unittest.TestCase):
                         os.path.abspath(layer_file_path),
                         resolver.Resolve(layer_identifier),
                     )
+                    # Identifiers and modification timestamps are cached as well
+                    anchor_path = Ar.ResolvedPath(os.path.join(temp_dir_path, "anchor.usd"))
+                    identifier = resolver.CreateIdentifier("./other.usd", anchor_path)
+                    self.assertEqual(identifier, resolver.CreateIdentifier("./other.usd", anchor_path))
+                    for _ in range(2):
+                        resolver.GetModificationTimestamp(layer_identifier, Ar.ResolvedPath(layer_file_path))
+                    # Repeated calls in the scope don't call into Python
+                    statistics = resolver.GetStatistics()
+                    self.assertEqual(statistics["scopedCacheHitCount"], 3)
+                    self.assertEqual(statistics["pythonCallCount"], call_count + 2)
                 # Uncached result should now return empty result
                 self.assertEqual("", resolver.Resolve(layer_identifier))
 
@@ -359,5 +371,35 @@ class TestArResolver(unittest.TestCase):
         self.assertEqual(ctx_data[PythonResolver.Tokens.mappingRegexFormat], "Cube")
 
 
+    def test_ResolverStatistics(self):
+        with tempfile.TemporaryDirectory() as temp_dir_path:
+            # Create context
+            ctx = PythonResolver.ResolverContext()
+            ctx_data = json.loads(ctx.GetData())
+            ctx_data[PythonResolver.Tokens.searchPaths] = [temp_dir_path]
+            ctx.SetData(json.dumps(ctx_data))
+            # Create files
+            layer_identifier = "layer.usd"
+            layer_file_path = os.path.join(temp_dir_path, layer_identifier)
+            Sdf.Layer.CreateAnonymous().Export(layer_file_path)
+            # Get resolver
+            resolver = Ar.GetResolver()
+            resolver.ResetStatistics()
+            self.assertEqual(resolver.GetStatistics()["pythonCallCount"], 0)
+            with Ar.ResolverContextBinder(ctx):
+                resolver.Resolve(layer_identifier)
+            statistics = resolver.GetStatistics()
+            self.assertEqual(statistics["resolveCount"], 1)
+            self.assertGreaterEqual(statistics["pythonCallCount"], 1)
+            self.assertGreater(statistics["pythonTime"], 0.0)
+            # Modification timestamps are queried via Python, they don't count as stat calls
+            resolver.ResetStatistics()
+            resolver.CreateDefaultContextForAsset(layer_file_path)
+            self.assertEqual(resolver.GetStatistics()["statCallCount"], 0)
+            # Reset
+            resolver.ResetStatistics()
+            self.assertEqual(resolver.GetStatistics()["resolveCount"], 0)
+
+
 if __name__ == "__main__":
     unittest.main()
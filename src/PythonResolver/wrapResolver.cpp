@@ -6,6 +6,8 @@
 #include BOOST_INCLUDE(python/class.hpp)
 #include BOOST_INCLUDE(python/return_value_policy.hpp)
 
+#include "python_dict.h"
+
 using namespace AR_BOOST_NAMESPACE::python;
 
 PXR_NAMESPACE_USING_DIRECTIVE
@@ -17,5 +19,11 @@ wrapResolver()
 
     class_<This, bases<ArResolver>, AR_BOOST_NAMESPACE::noncopyable>
         ("Resolver", no_init)
+        .def("GetStatistics", GetPythonDict<&This::GetStatistics>, "Returns the resolver statistics (operation/cache hit/Python call counts and accumulated Python/lock wait time in seconds) as a dict")
+        .def("ResetStatistics", &This::ResetStatistics, "Reset the resolver statistics")
+        .def("GetReadAheadStatistics", GetPythonDict<&This::GetReadAheadStatistics>, "Returns the read-ahead prefetch/dropped counts and the hit (prefetch finished before open)/late (prefetch still pending on open)/miss (not prefetched) open counts as a dict")
+        .def("ResetReadAheadStatistics", &This::ResetReadAheadStatistics, "Reset the read-ahead statistics")
+        .def("GetAssetCacheStatistics", GetPythonDict<&This::GetAssetCacheStatistics>, "Returns the memory mapped asset cache hit/miss/eviction counts, the cached entry count and the cached bytes as a dict")
+        .def("ClearAssetCache", &This::ClearAssetCache, "Drop all cached memory mapped assets (assets that are still in use stay valid)")
     ;
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#ifndef CONCURRENT_STRING_MAP_H
+#define CONCURRENT_STRING_MAP_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Concurrent String Map
+A string keyed hash map that is split into a fixed number of shards,
+where each shard is guarded by its own reader/writer lock.
+Lookups only take a shared lock on the single shard the key hashes to,
+so concurrent cache hits from multiple threads don't contend with each other
+and inserts from other threads only block readers of the same shard.
+*/
+template <typename Value, size_t ShardCount = 64>
+class ConcurrentStringMap
+{
+public:
+    using MapType = std::unordered_map<std::string, Value>;
+
+    ConcurrentStringMap() = default;
+    ConcurrentStringMap(const ConcurrentStringMap&) = delete;
+    ConcurrentStringMap& operator=(const ConcurrentStringMap&) = delete;
+
+    bool Find(const std::string& key, Value* value) const
+    {
+        const Shard& shard = this->_GetShard(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        if (value) {
+            *value = it->second;
+        }
+        return true;
+    }
+
+    bool Contains(const std::string& key) const
+    {
+        return this->Find(key, nullptr);
+    }
+
+    void InsertOrAssign(const std::string& key, const Value& value)
+    {
+        Shard& shard = this->_GetShard(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.map.insert_or_assign(key, value);
+    }
+
+    // Returns false if the key already exists, the existing value is kept in that case.
+    bool Insert(const std::string& key, const Value& value)
+    {
+        Shard& shard = this->_GetShard(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.try_emplace(key, value).second;
+    }
+
+    /* Returns the value of the key, if the key doesn't exist yet, the value returned by create()
+    gets inserted first. Concurrent callers of the same key all get the value of the first insert.
+    */
+    template <typename Create>
+    Value FindOrInsert(const std::string& key, const Create& create)
+    {
+        Shard& shard = this->_GetShard(key);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.map.find(key);
+            if (it != shard.map.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            it = shard.map.emplace(key, create()).first;
+        }
+        return it->second;
+    }
+
+    // Only assigns the desired value if the key is still mapped to the expected value.
+    bool CompareAndAssign(const std::string& key, const Value& expected, const Value& desired)
+    {
+        Shard& shard = this->_GetShard(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || !(it->second == expected)) {
+            return false;
+        }
+        it->second = desired;
+        return true;
+    }
+
+    bool Erase(const std::string& key)
+    {
+        Shard& shard = this->_GetShard(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.erase(key) != 0;
+    }
+
+    template <typename Predicate>
+    size_t EraseIf(const Predicate& predicate)
+    {
+        size_t count = 0;
+        for (Shard& shard : _shards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto it = shard.map.begin(); it != shard.map.end();) {
+                if (predicate(it->first, it->second)) {
+                    it = shard.map.erase(it);
+                    ++count;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return count;
+    }
+
+    /* Inserts (or assigns) all pairs in one pass, later pairs win on duplicate keys.
+    The pairs are bucketed by shard first, so that each shard is reserved once and
+    filled under a single lock, the keys/values are moved out of the pairs.
+    The parallelFor(shardCount, function(shardBegin, shardEnd)) callable
+    allows the caller to fill the shards in parallel.
+    */
+    template <typename ParallelFor>
+    void BulkInsertOrAssign(std::vector<std::pair<std::string, Value>>&& pairs, const ParallelFor& parallelFor)
+    {
+        std::array<std::vector<size_t>, ShardCount> shardPairIndices;
+        for (std::vector<size_t>& pairIndices : shardPairIndices) {
+            pairIndices.reserve(pairs.size() / ShardCount + 1);
+        }
+        for (size_t i = 0; i < pairs.size(); i++) {
+            shardPairIndices[_GetShardIndex(pairs[i].first)].push_back(i);
+        }
+        parallelFor(ShardCount, [this, &pairs, &shardPairIndices](size_t shardBegin, size_t shardEnd){
+            for (size_t shardIndex = shardBegin; shardIndex < shardEnd; shardIndex++) {
+                Shard& shard = _shards[shardIndex];
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                shard.map.reserve(shard.map.size() + shardPairIndices[shardIndex].size());
+                for (size_t i : shardPairIndices[shardIndex]) {
+                    shard.map.insert_or_assign(std::move(pairs[i].first), std::move(pairs[i].second));
+                }
+            }
+        });
+        pairs.clear();
+    }
+
+    void BulkInsertOrAssign(std::vector<std::pair<std::string, Value>>&& pairs)
+    {
+        this->BulkInsertOrAssign(std::move(pairs), [](size_t count, const auto& function){ function(0, count); });
+    }
+
+    void Clear()
+    {
+        for (Shard& shard : _shards) {
+            MapType staleMap;
+            {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                staleMap.swap(shard.map);
+            }
+            // The stale map gets freed here, outside of the lock.
+        }
+    }
+
+    size_t Size() const
+    {
+        size_t count = 0;
+        for (const Shard& shard : _shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.map.size();
+        }
+        return count;
+    }
+
+    bool Empty() const
+    {
+        for (const Shard& shard : _shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (!shard.map.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Function>
+    void ForEach(const Function& function) const
+    {
+        for (const Shard& shard : _shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& it : shard.map) {
+                function(it.first, it.second);
+            }
+        }
+    }
+
+    // Returns a sorted copy of all pairs, this is mainly used for Python exposure.
+    template <typename Convert>
+    std::map<std::string, std::string> GetSortedPairs(const Convert& convert) const
+    {
+        std::map<std::string, std::string> pairs;
+        this->ForEach([&pairs, &convert](const std::string& key, const Value& value){
+            pairs.emplace(key, convert(value));
+        });
+        return pairs;
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex;
+        MapType map;
+    };
+
+    static size_t _GetShardIndex(const std::string& key)
+    {
+        // Mix the upper bits in, as the lower bits are what the
+        // per shard unordered_map uses for its bucket selection.
+        const size_t hash = std::hash<std::string>()(key);
+        return (hash ^ (hash >> 32)) % ShardCount;
+    }
+
+    Shard& _GetShard(const std::string& key) { return _shards[_GetShardIndex(key)]; }
+    const Shard& _GetShard(const std::string& key) const { return _shards[_GetShardIndex(key)]; }
+
+    std::array<Shard, ShardCount> _shards;
+};
+
+#endif // CONCURRENT_STRING_MAP_H
@@ -0,0 +1,147 @@
+#ifndef CONTEXT_REGISTRY_H
+#define CONTEXT_REGISTRY_H
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/* Context Registry
+A process wide registry of resolver contexts, keyed by the (resolved) mapping file path,
+so that stages opening the same asset share one context instead of re-creating it.
+There is exactly one registry per context type (see GetInstance).
+
+- Thread safety: The registry lock is only held for the lookup itself. Creating or
+  refreshing a context (which can be expensive, e.g. when calling into Python) only
+  locks the entry, so concurrent stage opens of different mapping files don't block each other.
+- Budget: Once more than maxEntries contexts are registered, the least recently used
+  unused entries get evicted. Contexts that are still held outside of the registry (e.g. bound
+  to an open stage, see Context::IsShared) are never evicted, so that all stages of a mapping
+  file keep sharing one context. If all contexts are in use, the registry can exceed the budget.
+  A maxEntries of 0 disables the limit.
+- Fast path: The mapping file modification time is only re-checked if the last check
+  is older than the stat interval (in seconds), otherwise the cached context is returned as is.
+*/
+template <typename Context>
+class ContextRegistry
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static ContextRegistry& GetInstance()
+    {
+        static ContextRegistry instance;
+        return instance;
+    }
+
+    ContextRegistry(const ContextRegistry&) = delete;
+    ContextRegistry& operator=(const ContextRegistry&) = delete;
+
+    void Configure(size_t maxEntries, double statInterval)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxEntries = maxEntries;
+        _statInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(statInterval));
+        this->_EvictLocked();
+    }
+
+    /* Returns the registered context for the key.
+    The context is created via create() if it isn't registered yet and
+    refreshed via refresh(ctx) if getTimestamp() changed since the last check.
+    */
+    template <typename GetTimestamp, typename Create, typename Refresh>
+    Context FindOrCreate(const std::string& key,
+                         const GetTimestamp& getTimestamp,
+                         const Create& create,
+                         const Refresh& refresh)
+    {
+        std::shared_ptr<_Entry> entry;
+        Clock::duration statInterval;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(key);
+            if (it == _entries.end()) {
+                _lru.push_front(key);
+                it = _entries.emplace(key, std::make_shared<_Entry>()).first;
+                it->second->lruIt = _lru.begin();
+                this->_EvictLocked();
+            } else {
+                _lru.splice(_lru.begin(), _lru, it->second->lruIt);
+            }
+            entry = it->second;
+            statInterval = _statInterval;
+        }
+        std::lock_guard<std::mutex> entryLock(entry->mutex);
+        const Clock::time_point now = Clock::now();
+        if (!entry->ctx) {
+            entry->timestamp = getTimestamp();
+            entry->ctx.emplace(create());
+            entry->lastStatTime = now;
+        } else if (now - entry->lastStatTime >= statInterval) {
+            const double timestamp = getTimestamp();
+            entry->lastStatTime = now;
+            if (timestamp != entry->timestamp) {
+                entry->timestamp = timestamp;
+                refresh(*entry->ctx);
+            }
+        }
+        return *entry->ctx;
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _lru.clear();
+    }
+
+    size_t Size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size();
+    }
+
+private:
+    struct _Entry
+    {
+        std::mutex mutex;
+        // Optional, as some context default constructors already do (expensive) initialization.
+        std::optional<Context> ctx;
+        double timestamp{0.0};
+        Clock::time_point lastStatTime;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    ContextRegistry() = default;
+
+    void _EvictLocked()
+    {
+        auto lruIt = _lru.end();
+        while (_maxEntries != 0 && _entries.size() > _maxEntries && lruIt != _lru.begin()) {
+            --lruIt;
+            auto it = _entries.find(*lruIt);
+            std::shared_ptr<_Entry>& entry = it->second;
+            // Entries that are currently being looked up/created/refreshed or whose context is in use are kept.
+            std::unique_lock<std::mutex> entryLock(entry->mutex, std::try_to_lock);
+            if (entry.use_count() != 1 || !entryLock.owns_lock() || !entry->ctx || entry->ctx->IsShared()) {
+                continue;
+            }
+            entryLock.unlock();
+            _entries.erase(it);
+            lruIt = _lru.erase(lruIt);
+        }
+    }
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<_Entry>> _entries;
+    std::list<std::string> _lru;
+    size_t _maxEntries{0};
+    Clock::duration _statInterval{0};
+};
+
+#endif // CONTEXT_REGISTRY_H
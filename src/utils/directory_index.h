@@ -0,0 +1,189 @@
+#ifndef DIRECTORY_INDEX_H
+#define DIRECTORY_INDEX_H
+
+#include "concurrent_string_map.h"
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/fileSystem.h"
+#include "pxr/base/tf/fileUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Directory Index
+An opt-in, process wide index of directory listings, that answers "does the relative path
+exist under the search path" from memory. Each directory along the relative path costs a
+hash probe instead of a (network) stat, so resolving against many search paths doesn't
+stat every search path on every miss.
+
+- Listings are read lazily on the first lookup that walks through a directory.
+- A listing is re-read once the directory modification time changed, which is only
+  re-checked if the last check is older than the stat interval (in seconds).
+  Files that are added within the stat interval may therefore not be found right away.
+  Listings read within the modification time granularity are re-read on every check,
+  as changes in the same second don't change the modification time.
+- GetListing exposes the (sorted) listings regardless of the enabled state,
+  so that other directory scans (e.g. latest version lookups) share the same cache.
+- Names are compared case-sensitively, so the index should only be enabled on
+  case-sensitive file systems.
+- Lookup returns false if the index can't answer (e.g. for "../" components),
+  the caller then falls back to a regular stat.
+Listings are kept until Clear is called, so the memory grows with the number of looked up directories.
+*/
+class DirectoryIndex
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Listing
+    {
+        double modificationTime{0.0};
+        // Listings read within the modification time granularity can miss later changes of the same second.
+        bool isRacy{false};
+        // Sorted, so that names can be binary searched and names with a common prefix are a contiguous range.
+        std::vector<std::string> dirNames;
+        std::vector<std::string> fileNames;
+    };
+
+    static DirectoryIndex& GetInstance()
+    {
+        static DirectoryIndex instance;
+        return instance;
+    }
+
+    DirectoryIndex(const DirectoryIndex&) = delete;
+    DirectoryIndex& operator=(const DirectoryIndex&) = delete;
+
+    void Configure(bool isEnabled, double statInterval)
+    {
+        this->SetStatInterval(statInterval);
+        _isEnabled = isEnabled;
+    }
+
+    void SetStatInterval(double statInterval)
+    {
+        _statInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(statInterval)).count();
+    }
+
+    void SetEnabled(bool isEnabled) { _isEnabled = isEnabled; }
+    bool IsEnabled() const { return _isEnabled; }
+
+    bool Lookup(const std::string& rootPath, const std::string& relativePath, bool* exists)
+    {
+        if (!_isEnabled || rootPath.empty() || relativePath.empty()) {
+            return false;
+        }
+        std::vector<std::string> names;
+        size_t begin = 0;
+        while (begin <= relativePath.size()) {
+            size_t end = relativePath.find_first_of("/\\", begin);
+            if (end == std::string::npos) {
+                end = relativePath.size();
+            }
+            const std::string name = relativePath.substr(begin, end - begin);
+            if (name.empty() || name == "." || name == "..") {
+                return false;
+            }
+            names.push_back(name);
+            begin = end + 1;
+        }
+        std::string dirPath = rootPath;
+        while (dirPath.size() > 1 && (dirPath.back() == '/' || dirPath.back() == '\\')) {
+            dirPath.pop_back();
+        }
+        ++_lookupCount;
+        for (const std::string& name : names) {
+            const std::shared_ptr<const Listing> listing = this->GetListing(dirPath);
+            if (!std::binary_search(listing->dirNames.begin(), listing->dirNames.end(), name) &&
+                !std::binary_search(listing->fileNames.begin(), listing->fileNames.end(), name)) {
+                *exists = false;
+                return true;
+            }
+            dirPath += "/" + name;
+        }
+        *exists = true;
+        return true;
+    }
+
+    std::map<std::string, double> GetStatistics() const
+    {
+        return {
+            {"lookupCount", static_cast<double>(_lookupCount.load())},
+            {"statCount", static_cast<double>(_statCount.load())},
+            {"listCount", static_cast<double>(_listCount.load())},
+            {"directoryCount", static_cast<double>(_directories.Size())}
+        };
+    }
+
+    void Clear()
+    {
+        _directories.Clear();
+        _lookupCount = 0;
+        _statCount = 0;
+        _listCount = 0;
+    }
+
+    // Returns the listing of the directory, an empty listing if it doesn't exist.
+    std::shared_ptr<const Listing> GetListing(const std::string& dirPath)
+    {
+        const std::shared_ptr<_Directory> directory = _directories.FindOrInsert(dirPath, [](){ return std::make_shared<_Directory>(); });
+        const Clock::rep now = Clock::now().time_since_epoch().count();
+        std::shared_ptr<const Listing> listing = std::atomic_load(&directory->listing);
+        if (listing && now - directory->lastStatTime.load() < _statInterval.load()) {
+            return listing;
+        }
+        // Concurrent lookups in the same directory wait for a single stat/directory read.
+        std::lock_guard<std::mutex> lock(directory->mutex);
+        listing = std::atomic_load(&directory->listing);
+        if (listing && now - directory->lastStatTime.load() < _statInterval.load()) {
+            return listing;
+        }
+        ++_statCount;
+        double modificationTime = 0.0;
+        if (!PXR_NS::ArchGetModificationTime(dirPath.c_str(), &modificationTime)) {
+            modificationTime = 0.0;
+        }
+        if (!listing || listing->isRacy || modificationTime != listing->modificationTime) {
+            ++_listCount;
+            std::shared_ptr<Listing> newListing = std::make_shared<Listing>();
+            newListing->modificationTime = modificationTime;
+            const double currentTime = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            newListing->isRacy = currentTime - modificationTime < 2.0;
+            if (modificationTime != 0.0) {
+                PXR_NS::TfReadDir(dirPath, &newListing->dirNames, &newListing->fileNames, nullptr);
+                std::sort(newListing->dirNames.begin(), newListing->dirNames.end());
+                std::sort(newListing->fileNames.begin(), newListing->fileNames.end());
+            }
+            listing = newListing;
+            std::atomic_store(&directory->listing, listing);
+        }
+        directory->lastStatTime = now;
+        return listing;
+    }
+
+private:
+    struct _Directory
+    {
+        std::mutex mutex;
+        std::atomic<Clock::rep> lastStatTime{0};
+        std::shared_ptr<const Listing> listing;
+    };
+
+    DirectoryIndex() = default;
+
+    std::atomic<bool> _isEnabled{false};
+    std::atomic<Clock::rep> _statInterval{0};
+    ConcurrentStringMap<std::shared_ptr<_Directory>> _directories;
+    std::atomic<uint64_t> _lookupCount{0};
+    std::atomic<uint64_t> _statCount{0};
+    std::atomic<uint64_t> _listCount{0};
+};
+
+#endif // DIRECTORY_INDEX_H
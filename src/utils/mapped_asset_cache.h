@@ -0,0 +1,192 @@
+#ifndef MAPPED_ASSET_CACHE_H
+#define MAPPED_ASSET_CACHE_H
+
+#include "pxr/pxr.h"
+#include "pxr/base/arch/fileSystem.h"
+#include "pxr/usd/ar/asset.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/* Mapped Asset Cache
+A process wide cache of read-only memory mapped assets, so that stages in the same process
+(e.g. multiple LOP networks/viewports) that open the same file share a single mapping
+instead of each opening and reading the file. GetBuffer() returns a view into the mapping,
+so nothing gets copied.
+
+- Entries are keyed by the resolved path and validated against the file modification time
+  on every open, a changed file gets re-mapped.
+- The cache is bounded by a byte budget, once it is exceeded the least recently opened
+  entries get evicted. Evicting only drops the cache reference, assets that are still
+  in use keep their mapping alive. Files that exceed the budget on their own aren't cached.
+- A budget of 0 disables the cache, Open then always returns nullptr so that
+  the caller falls back to a regular file system asset.
+As with all memory mapped files, files must not be truncated while they are mapped.
+*/
+class MappedAssetCache
+{
+public:
+    static MappedAssetCache& GetInstance()
+    {
+        static MappedAssetCache instance;
+        return instance;
+    }
+
+    MappedAssetCache(const MappedAssetCache&) = delete;
+    MappedAssetCache& operator=(const MappedAssetCache&) = delete;
+
+    void Configure(size_t maxBytes)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxBytes = maxBytes;
+        this->_EvictLocked();
+    }
+
+    // Returns nullptr if the cache is disabled or the file can't be mapped.
+    std::shared_ptr<PXR_NS::ArAsset> Open(const std::string& resolvedPath)
+    {
+        if (_maxBytes == 0) {
+            return nullptr;
+        }
+        double modificationTime = 0.0;
+        if (!PXR_NS::ArchGetModificationTime(resolvedPath.c_str(), &modificationTime)) {
+            return nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(resolvedPath);
+            if (it != _entries.end()) {
+                if (it->second.modificationTime == modificationTime) {
+                    _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+                    ++_hitCount;
+                    return it->second.asset;
+                }
+                this->_EraseLocked(it);
+            }
+        }
+        // Map the file outside of the lock, so that opening large files doesn't block other opens.
+        ++_missCount;
+        PXR_NS::ArchConstFileMapping mapping = PXR_NS::ArchMapFileReadOnly(resolvedPath);
+        if (!mapping) {
+            return nullptr;
+        }
+        const size_t size = PXR_NS::ArchGetFileMappingLength(mapping);
+        std::shared_ptr<PXR_NS::ArAsset> asset = std::make_shared<_MappedAsset>(std::move(mapping), size);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (size > _maxBytes) {
+            return asset;
+        }
+        auto it = _entries.find(resolvedPath);
+        if (it != _entries.end()) {
+            if (it->second.modificationTime == modificationTime) {
+                // Another thread mapped the same file in the meantime.
+                return it->second.asset;
+            }
+            this->_EraseLocked(it);
+        }
+        _lru.push_front(resolvedPath);
+        _entries.emplace(resolvedPath, _Entry{modificationTime, size, asset, _lru.begin()});
+        _usedBytes += size;
+        this->_EvictLocked();
+        return asset;
+    }
+
+    std::map<std::string, double> GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return {
+            {"hitCount", static_cast<double>(_hitCount)},
+            {"missCount", static_cast<double>(_missCount)},
+            {"evictionCount", static_cast<double>(_evictionCount)},
+            {"entryCount", static_cast<double>(_entries.size())},
+            {"usedBytes", static_cast<double>(_usedBytes)}
+        };
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _lru.clear();
+        _usedBytes = 0;
+    }
+
+private:
+    class _MappedAsset : public PXR_NS::ArAsset
+    {
+    public:
+        _MappedAsset(PXR_NS::ArchConstFileMapping&& mapping, size_t size)
+            : _mapping(std::make_shared<PXR_NS::ArchConstFileMapping>(std::move(mapping))), _size(size) {}
+
+        size_t GetSize() const override { return _size; }
+
+        std::shared_ptr<const char> GetBuffer() const override
+        {
+            // Share ownership of the mapping, so that the buffer stays valid after eviction.
+            return std::shared_ptr<const char>(_mapping, _mapping->get());
+        }
+
+        size_t Read(void* buffer, size_t count, size_t offset) const override
+        {
+            if (offset >= _size) {
+                return 0;
+            }
+            const size_t readCount = std::min(count, _size - offset);
+            std::memcpy(buffer, _mapping->get() + offset, readCount);
+            return readCount;
+        }
+
+        std::pair<FILE*, size_t> GetFileUnsafe() const override { return std::make_pair(nullptr, 0); }
+
+    private:
+        std::shared_ptr<PXR_NS::ArchConstFileMapping> _mapping;
+        size_t _size;
+    };
+
+    struct _Entry
+    {
+        double modificationTime;
+        size_t size;
+        std::shared_ptr<PXR_NS::ArAsset> asset;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    MappedAssetCache() = default;
+
+    void _EraseLocked(std::unordered_map<std::string, _Entry>::iterator it)
+    {
+        _usedBytes -= it->second.size;
+        _lru.erase(it->second.lruIt);
+        _entries.erase(it);
+    }
+
+    void _EvictLocked()
+    {
+        while (_usedBytes > _maxBytes && !_lru.empty()) {
+            this->_EraseLocked(_entries.find(_lru.back()));
+            ++_evictionCount;
+        }
+    }
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, _Entry> _entries;
+    std::list<std::string> _lru;
+    std::atomic<size_t> _maxBytes{0};
+    size_t _usedBytes{0};
+    uint64_t _hitCount{0};
+    std::atomic<uint64_t> _missCount{0};
+    uint64_t _evictionCount{0};
+};
+
+#endif // MAPPED_ASSET_CACHE_H
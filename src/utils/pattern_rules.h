@@ -0,0 +1,410 @@
+#ifndef PATTERN_RULES_H
+#define PATTERN_RULES_H
+
+#include "concurrent_string_map.h"
+
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Pattern Rules
+An ordered list of (regex, format) rules, that are compiled once when they are added.
+A rule matches if its regex matches the whole input string, the result is then the
+format string with its $1, $2, ... ($& for the whole match) references replaced by
+the regex groups. The first matching rule wins.
+Rules are guarded by a reader/writer lock, the rule count is tracked separately,
+so that lists without any rules don't have to take the lock.
+Replace is the search (instead of whole match) counterpart, the first rule whose regex is
+found in the input wins and all of its matches get replaced (same as std::regex_replace).
+If maxCachedResults is non-zero, the Match results (including misses, stored as empty strings)
+are memoized per input string, so each input only gets matched once. Once the cache holds
+maxCachedResults inputs it starts over, so that it is bounded and follows the current
+working set. The cache is also cleared whenever the rules change.
+
+Literal Prefilter
+std::regex is slow, so we only evaluate rules that can possibly match. For each rule we
+extract the longest literal that every match has to contain (e.g. "/assets/" for
+"(.*)/assets/(\w+)_v\d+\.usd"). The literals of all rules are compiled into an Aho-Corasick
+automaton, a single pass over the input then yields all rules whose literal it contains.
+Rules without an extractable literal (e.g. top level alternations) are always evaluated.
+*/
+class PatternRules
+{
+public:
+    explicit PatternRules(size_t maxCachedResults = 0) : _maxCachedResults(maxCachedResults) {}
+    PatternRules(const PatternRules&) = delete;
+    PatternRules& operator=(const PatternRules&) = delete;
+
+    // Returns false (and the regex error via errorMsg) if the regex is invalid.
+    bool Add(const std::string& regexExpressionStr, const std::string& formatStr, std::string* errorMsg = nullptr)
+    {
+        _Rule rule;
+        try {
+            rule.regexExpression = std::regex(regexExpressionStr);
+        } catch (const std::regex_error& e) {
+            if (errorMsg) {
+                *errorMsg = e.what();
+            }
+            return false;
+        }
+        rule.regexExpressionStr = regexExpressionStr;
+        rule.formatStr = formatStr;
+        rule.literalStr = GetRequiredLiteral(regexExpressionStr);
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        _rules.push_back(std::move(rule));
+        _ruleCount = _rules.size();
+        this->_BuildPrefilter();
+        this->_ClearResults();
+        return true;
+    }
+
+    std::vector<std::pair<std::string, std::string>> Get() const
+    {
+        std::vector<std::pair<std::string, std::string>> rules;
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        rules.reserve(_rules.size());
+        for (const _Rule& rule : _rules) {
+            rules.emplace_back(rule.regexExpressionStr, rule.formatStr);
+        }
+        return rules;
+    }
+
+    void Clear()
+    {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        _rules.clear();
+        _ruleCount = 0;
+        this->_BuildPrefilter();
+        this->_ClearResults();
+    }
+
+    size_t Size() const { return _ruleCount; }
+
+    bool Match(const std::string& str, std::string* result) const
+    {
+        if (_ruleCount == 0) {
+            return false;
+        }
+        std::string matchResult;
+        if (_maxCachedResults == 0 || !_results.Find(str, &matchResult)) {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            const std::vector<char> candidates = this->_GetCandidates(str);
+            std::smatch match;
+            for (size_t i = 0; i < _rules.size(); i++) {
+                if (candidates[i] && std::regex_match(str, match, _rules[i].regexExpression)) {
+                    matchResult = match.format(_rules[i].formatStr);
+                    break;
+                }
+            }
+            // This is done under the lock, so that we never cache results of removed rules.
+            if (_maxCachedResults != 0) {
+                this->_CacheResult(str, matchResult);
+            }
+        }
+        if (matchResult.empty()) {
+            return false;
+        }
+        *result = std::move(matchResult);
+        return true;
+    }
+
+    bool Replace(const std::string& str, std::string* result) const
+    {
+        if (_ruleCount == 0) {
+            return false;
+        }
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        const std::vector<char> candidates = this->_GetCandidates(str);
+        const std::sregex_iterator endIt;
+        for (size_t i = 0; i < _rules.size(); i++) {
+            if (!candidates[i]) {
+                continue;
+            }
+            // Same as std::regex_replace, but we only search the input once to find out if the rule matches.
+            std::sregex_iterator it(str.begin(), str.end(), _rules[i].regexExpression);
+            if (it == endIt) {
+                continue;
+            }
+            std::string replacedStr;
+            std::string::const_iterator suffixBegin = str.begin();
+            for (; it != endIt; ++it) {
+                replacedStr.append(it->prefix().first, it->prefix().second);
+                replacedStr += it->format(_rules[i].formatStr);
+                suffixBegin = it->suffix().first;
+            }
+            replacedStr.append(suffixBegin, str.end());
+            *result = std::move(replacedStr);
+            return true;
+        }
+        return false;
+    }
+
+    /*
+    Returns the longest literal that every match of the (ECMAScript) regex contains,
+    or an empty string if there is none or the regex can't be analyzed. This is
+    conservative, groups, classes and escapes other than escaped punctuation end a literal.
+    */
+    static std::string GetRequiredLiteral(const std::string& regexExpressionStr)
+    {
+        const std::string& str = regexExpressionStr;
+        std::string literalStr;
+        std::string runStr;
+        bool isLastLiteral = false;
+        auto endRun = [&](){
+            if (runStr.size() > literalStr.size()) {
+                literalStr = runStr;
+            }
+            runStr.clear();
+            isLastLiteral = false;
+        };
+        for (size_t i = 0; i < str.size(); i++) {
+            const char c = str[i];
+            switch (c) {
+                case '\\': {
+                    if (++i >= str.size()) {
+                        return std::string();
+                    }
+                    const char escapedChar = str[i];
+                    if (!std::isalnum(static_cast<unsigned char>(escapedChar))) {
+                        runStr += escapedChar;
+                        isLastLiteral = true;
+                        break;
+                    }
+                    // Character class escapes, back references and char codes.
+                    if (escapedChar == 'x') {
+                        i += 2;
+                    } else if (escapedChar == 'u') {
+                        i += 4;
+                    } else if (escapedChar == 'c') {
+                        i += 1;
+                    } else {
+                        while (std::isdigit(static_cast<unsigned char>(escapedChar)) && i + 1 < str.size() &&
+                               std::isdigit(static_cast<unsigned char>(str[i + 1]))) {
+                            i++;
+                        }
+                    }
+                    endRun();
+                    break;
+                }
+                case '(': {
+                    endRun();
+                    if (!_SkipGroup(str, &i)) {
+                        return std::string();
+                    }
+                    break;
+                }
+                case '[': {
+                    endRun();
+                    if (!_SkipClass(str, &i)) {
+                        return std::string();
+                    }
+                    break;
+                }
+                case '?':
+                case '*': {
+                    // The preceding character is optional.
+                    if (isLastLiteral) {
+                        runStr.pop_back();
+                    }
+                    endRun();
+                    break;
+                }
+                case '+': {
+                    endRun();
+                    break;
+                }
+                case '{': {
+                    const size_t endPos = str.find('}', i);
+                    if (endPos == std::string::npos || !std::isdigit(static_cast<unsigned char>(str[i + 1]))) {
+                        return std::string();
+                    }
+                    if (isLastLiteral && std::stoul(str.substr(i + 1, endPos - i - 1)) == 0) {
+                        runStr.pop_back();
+                    }
+                    i = endPos;
+                    endRun();
+                    break;
+                }
+                case '.':
+                case '^':
+                case '$': {
+                    endRun();
+                    break;
+                }
+                case '|':
+                case ')':
+                case ']':
+                case '}': {
+                    return std::string();
+                }
+                default: {
+                    runStr += c;
+                    isLastLiteral = true;
+                    break;
+                }
+            }
+        }
+        endRun();
+        return literalStr;
+    }
+
+private:
+    struct _Rule
+    {
+        std::string regexExpressionStr;
+        std::regex regexExpression;
+        std::string formatStr;
+        std::string literalStr;
+    };
+
+    // Aho-Corasick automaton, the failure links are folded into the transitions
+    // so that each input character costs a single table lookup.
+    struct _Prefilter
+    {
+        std::vector<std::array<int32_t, 256>> transitions;
+        std::vector<std::vector<size_t>> ruleIndices;
+        std::vector<size_t> unfilteredRuleIndices;
+    };
+
+    static bool _SkipClass(const std::string& str, size_t* pos)
+    {
+        for (size_t i = *pos + 1; i < str.size(); i++) {
+            if (str[i] == '\\') {
+                i++;
+            } else if (str[i] == ']') {
+                *pos = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool _SkipGroup(const std::string& str, size_t* pos)
+    {
+        size_t depth = 0;
+        for (size_t i = *pos; i < str.size(); i++) {
+            if (str[i] == '\\') {
+                i++;
+            } else if (str[i] == '[') {
+                if (!_SkipClass(str, &i)) {
+                    return false;
+                }
+            } else if (str[i] == '(') {
+                depth++;
+            } else if (str[i] == ')' && --depth == 0) {
+                *pos = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void _BuildPrefilter()
+    {
+        _Prefilter prefilter;
+        std::array<int32_t, 256> emptyTransitions;
+        emptyTransitions.fill(-1);
+        prefilter.transitions.push_back(emptyTransitions);
+        prefilter.ruleIndices.emplace_back();
+        for (size_t ruleIndex = 0; ruleIndex < _rules.size(); ruleIndex++) {
+            const std::string& literalStr = _rules[ruleIndex].literalStr;
+            if (literalStr.empty()) {
+                prefilter.unfilteredRuleIndices.push_back(ruleIndex);
+                continue;
+            }
+            int32_t node = 0;
+            for (const char c : literalStr) {
+                int32_t& nextNode = prefilter.transitions[node][static_cast<unsigned char>(c)];
+                if (nextNode == -1) {
+                    nextNode = static_cast<int32_t>(prefilter.transitions.size());
+                    prefilter.transitions.push_back(emptyTransitions);
+                    prefilter.ruleIndices.emplace_back();
+                }
+                node = prefilter.transitions[node][static_cast<unsigned char>(c)];
+            }
+            prefilter.ruleIndices[node].push_back(ruleIndex);
+        }
+        // Breadth first, so that the failure node of each node is complete before it gets visited.
+        std::vector<int32_t> failureNodes(prefilter.transitions.size(), 0);
+        std::vector<int32_t> queue;
+        for (int32_t& nextNode : prefilter.transitions[0]) {
+            if (nextNode == -1) {
+                nextNode = 0;
+            } else {
+                queue.push_back(nextNode);
+            }
+        }
+        for (size_t queueIndex = 0; queueIndex < queue.size(); queueIndex++) {
+            const int32_t node = queue[queueIndex];
+            const int32_t failureNode = failureNodes[node];
+            prefilter.ruleIndices[node].insert(prefilter.ruleIndices[node].end(),
+                                               prefilter.ruleIndices[failureNode].begin(),
+                                               prefilter.ruleIndices[failureNode].end());
+            for (size_t c = 0; c < 256; c++) {
+                int32_t& nextNode = prefilter.transitions[node][c];
+                if (nextNode == -1) {
+                    nextNode = prefilter.transitions[failureNode][c];
+                } else {
+                    failureNodes[nextNode] = prefilter.transitions[failureNode][c];
+                    queue.push_back(nextNode);
+                }
+            }
+        }
+        _prefilter = std::move(prefilter);
+    }
+
+    // Has to be called with the (shared) lock held.
+    std::vector<char> _GetCandidates(const std::string& str) const
+    {
+        std::vector<char> candidates(_rules.size(), 0);
+        for (const size_t ruleIndex : _prefilter.unfilteredRuleIndices) {
+            candidates[ruleIndex] = 1;
+        }
+        if (_prefilter.unfilteredRuleIndices.size() == _rules.size()) {
+            return candidates;
+        }
+        int32_t node = 0;
+        for (const char c : str) {
+            node = _prefilter.transitions[node][static_cast<unsigned char>(c)];
+            for (const size_t ruleIndex : _prefilter.ruleIndices[node]) {
+                candidates[ruleIndex] = 1;
+            }
+        }
+        return candidates;
+    }
+
+    void _ClearResults() const
+    {
+        _results.Clear();
+        _resultCount = 0;
+    }
+
+    // Has to be called with the (shared) lock held.
+    void _CacheResult(const std::string& str, const std::string& matchResult) const
+    {
+        if (_resultCount.load(std::memory_order_relaxed) >= _maxCachedResults) {
+            this->_ClearResults();
+        }
+        if (_results.Insert(str, matchResult)) {
+            _resultCount++;
+        }
+    }
+
+    const size_t _maxCachedResults;
+    mutable std::shared_mutex _mutex;
+    std::vector<_Rule> _rules;
+    _Prefilter _prefilter;
+    std::atomic<size_t> _ruleCount{0};
+    mutable ConcurrentStringMap<std::string> _results;
+    mutable std::atomic<size_t> _resultCount{0};
+};
+
+#endif // PATTERN_RULES_H
@@ -0,0 +1,183 @@
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/* Prefix Trie
+A compact (path compressed) radix trie with longest prefix match lookups.
+Each node stores the edge label leading to it, so a lookup only touches
+one node per distinct prefix and costs O(key length), regardless of how
+many prefixes are stored. Children are kept sorted by their first edge
+character, so the child lookup per node is a binary search.
+This is not thread safe, guard it with a lock if it is edited while it is read.
+*/
+template <typename Value>
+class PrefixTrie
+{
+public:
+    PrefixTrie() : _root(new _Node()) {}
+
+    void InsertOrAssign(const std::string& key, const Value& value)
+    {
+        _Node* node = _root.get();
+        std::string_view remainder(key);
+        while (!remainder.empty()) {
+            auto childIt = node->FindChild(remainder[0]);
+            if (childIt == node->children.end() || (*childIt)->edge[0] != remainder[0]) {
+                // No child shares a prefix with the remainder, add a leaf.
+                std::unique_ptr<_Node> leaf(new _Node());
+                leaf->edge = std::string(remainder);
+                leaf->hasValue = true;
+                leaf->value = value;
+                node->children.insert(childIt, std::move(leaf));
+                ++_size;
+                return;
+            }
+            _Node* child = childIt->get();
+            const size_t commonSize = _GetCommonPrefixSize(child->edge, remainder);
+            if (commonSize < child->edge.size()) {
+                // Split the child edge at the common prefix.
+                std::unique_ptr<_Node> split(new _Node());
+                split->edge = child->edge.substr(0, commonSize);
+                child->edge.erase(0, commonSize);
+                split->children.push_back(std::move(*childIt));
+                *childIt = std::move(split);
+                child = childIt->get();
+            }
+            remainder.remove_prefix(commonSize);
+            node = child;
+        }
+        if (!node->hasValue) {
+            ++_size;
+        }
+        node->hasValue = true;
+        node->value = value;
+    }
+
+    bool Erase(const std::string& key)
+    {
+        _Node* node = _root.get();
+        std::string_view remainder(key);
+        while (!remainder.empty()) {
+            auto childIt = node->FindChild(remainder[0]);
+            if (childIt == node->children.end() || (*childIt)->edge[0] != remainder[0] ||
+                remainder.compare(0, (*childIt)->edge.size(), (*childIt)->edge) != 0) {
+                return false;
+            }
+            remainder.remove_prefix((*childIt)->edge.size());
+            node = childIt->get();
+        }
+        if (!node->hasValue) {
+            return false;
+        }
+        // We don't re-merge the edges here, as removals are rare.
+        node->hasValue = false;
+        node->value = Value();
+        --_size;
+        return true;
+    }
+
+    // Returns the value of the longest stored prefix of the key and the size of that prefix.
+    bool FindLongestPrefix(std::string_view key, const Value** value, size_t* prefixSize) const
+    {
+        const _Node* node = _root.get();
+        const _Node* match = node->hasValue ? node : nullptr;
+        size_t matchSize = 0;
+        size_t offset = 0;
+        while (offset < key.size()) {
+            auto childIt = node->FindChild(key[offset]);
+            if (childIt == node->children.end() || (*childIt)->edge[0] != key[offset]) {
+                break;
+            }
+            const std::string& edge = (*childIt)->edge;
+            if (key.compare(offset, edge.size(), edge) != 0) {
+                break;
+            }
+            offset += edge.size();
+            node = childIt->get();
+            if (node->hasValue) {
+                match = node;
+                matchSize = offset;
+            }
+        }
+        if (!match) {
+            return false;
+        }
+        *value = &match->value;
+        *prefixSize = matchSize;
+        return true;
+    }
+
+    void Clear()
+    {
+        _root.reset(new _Node());
+        _size = 0;
+    }
+
+    size_t Size() const { return _size; }
+    bool Empty() const { return _size == 0; }
+
+    // Calls the function with all key/value pairs in sorted key order.
+    template <typename Function>
+    void ForEach(const Function& function) const
+    {
+        std::string key;
+        _ForEach(*_root, key, function);
+    }
+
+private:
+    struct _Node
+    {
+        std::string edge;
+        bool hasValue{false};
+        Value value{};
+        std::vector<std::unique_ptr<_Node>> children;
+
+        // Returns the child whose edge starts with the character or the insert position.
+        typename std::vector<std::unique_ptr<_Node>>::iterator FindChild(char character)
+        {
+            return std::lower_bound(children.begin(), children.end(), character,
+                [](const std::unique_ptr<_Node>& child, char c){ return child->edge[0] < c; });
+        }
+        typename std::vector<std::unique_ptr<_Node>>::const_iterator FindChild(char character) const
+        {
+            return std::lower_bound(children.begin(), children.end(), character,
+                [](const std::unique_ptr<_Node>& child, char c){ return child->edge[0] < c; });
+        }
+    };
+
+    static size_t _GetCommonPrefixSize(const std::string& edge, std::string_view key)
+    {
+        const size_t maxSize = std::min(edge.size(), key.size());
+        size_t size = 0;
+        while (size < maxSize && edge[size] == key[size]) {
+            ++size;
+        }
+        return size;
+    }
+
+    template <typename Function>
+    static void _ForEach(const _Node& node, std::string& key, const Function& function)
+    {
+        if (node.hasValue) {
+            function(key, node.value);
+        }
+        for (const auto& child : node.children) {
+            key.append(child->edge);
+            _ForEach(*child, key, function);
+            key.resize(key.size() - child->edge.size());
+        }
+    }
+
+    std::unique_ptr<_Node> _root;
+    size_t _size{0};
+};
+
+#endif // PREFIX_TRIE_H
@@ -0,0 +1,55 @@
+#ifndef PYTHON_DICT_H
+#define PYTHON_DICT_H
+
+#include "boost_include_wrapper.h"
+#include BOOST_INCLUDE(python/dict.hpp)
+
+#include <map>
+
+/* Python Dict
+Converts (nested) std::maps to Python dicts, nested maps become nested dicts.
+GetPythonDict wraps a const getter that returns a map, so that it can be exposed directly, e.g.
+> .def("GetStatistics", GetPythonDict<&FileResolver::GetStatistics>)
+This is only meant to be included by the Python bindings.
+*/
+template <typename Key, typename Value>
+AR_BOOST_NAMESPACE::python::dict ToPythonDict(const std::map<Key, Value>& map);
+
+template <typename Value>
+const Value& _ToPythonDictValue(const Value& value)
+{
+    return value;
+}
+
+template <typename Key, typename Value>
+AR_BOOST_NAMESPACE::python::dict _ToPythonDictValue(const std::map<Key, Value>& map)
+{
+    return ToPythonDict(map);
+}
+
+template <typename Key, typename Value>
+AR_BOOST_NAMESPACE::python::dict ToPythonDict(const std::map<Key, Value>& map)
+{
+    AR_BOOST_NAMESPACE::python::dict result;
+    for (const auto& it : map) {
+        result[it.first] = _ToPythonDictValue(it.second);
+    }
+    return result;
+}
+
+template <typename Getter>
+struct _PythonDictGetterClass;
+
+template <typename Class, typename Result>
+struct _PythonDictGetterClass<Result (Class::*)() const>
+{
+    using Type = Class;
+};
+
+template <auto Getter>
+AR_BOOST_NAMESPACE::python::dict GetPythonDict(const typename _PythonDictGetterClass<decltype(Getter)>::Type& obj)
+{
+    return ToPythonDict((obj.*Getter)());
+}
+
+#endif // PYTHON_DICT_H
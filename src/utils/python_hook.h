@@ -0,0 +1,218 @@
+#ifndef PYTHON_HOOK_H
+#define PYTHON_HOOK_H
+
+#include "pxr/pxr.h"
+#include "pxr/base/tf/pyError.h"
+#include "pxr/base/tf/pyInvoke.h"
+#include "pxr/base/tf/pyLock.h"
+#include "pxr/base/tf/pyUtils.h"
+#include "pxr/base/tf/stringUtils.h"
+
+#include "boost_include_wrapper.h"
+#include BOOST_INCLUDE(python/errors.hpp)
+#include BOOST_INCLUDE(python/extract.hpp)
+#include BOOST_INCLUDE(python/handle.hpp)
+#include BOOST_INCLUDE(python/object.hpp)
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* Python Hook
+A Python callable (e.g. "Resolver.ResolveAndCache" of the PythonExpose module), that is looked up
+once and then called directly. TfPyInvoke instead imports the module, looks up the (dotted) attribute
+and builds a new argument tuple on every call, which we pay for on every resolver cache miss.
+
+- Re-binding: Before each call we check (via two dict lookups) that the module in sys.modules and
+  its top level attribute (e.g. the Resolver class) are still the objects we bound to, so that
+  module reloads (importlib.reload) and replaced modules are picked up.
+- Argument re-use: The argument tuple is kept and refilled on the next call, unless the callee kept
+  a reference to it or the hook is called re-entrantly (e.g. a hook that resolves another asset).
+- Errors: Python exceptions are converted to Tf errors, Call/CallAndExtract then return false
+  (the same as TfPyInvoke/TfPyInvokeAndExtract).
+As with TfPyInvoke, the interpreter gets initialized on the first call, if the host application
+(e.g. a C++ only executable) didn't initialize it. All state is only accessed while holding the GIL.
+Hooks are meant to be static and the Python references are intentionally never released,
+as Python may already be finalized on process exit.
+*/
+class PythonHook
+{
+public:
+    PythonHook(const std::string& moduleName, const std::string& functionPath)
+        : _moduleName(moduleName), _functionPath(functionPath), _attributeNames(PXR_NS::TfStringSplit(functionPath, "."))
+    {}
+
+    PythonHook(const PythonHook&) = delete;
+    PythonHook& operator=(const PythonHook&) = delete;
+
+    const std::string& GetModuleName() const { return _moduleName; }
+    const std::string& GetFunctionPath() const { return _functionPath; }
+
+    template <typename... Args>
+    bool Call(const Args&... args) const
+    {
+        PXR_NS::TfPyInitialize();
+        PXR_NS::TfPyLock pyLock;
+        PyObject* pyResult = this->_Call(args...);
+        Py_XDECREF(pyResult);
+        return pyResult != nullptr;
+    }
+
+    template <typename Result, typename... Args>
+    bool CallAndExtract(Result* result, const Args&... args) const
+    {
+        PXR_NS::TfPyInitialize();
+        PXR_NS::TfPyLock pyLock;
+        PyObject* pyResult = this->_Call(args...);
+        if (!pyResult) {
+            return false;
+        }
+        try {
+            AR_BOOST_NAMESPACE::python::object resultObject{AR_BOOST_NAMESPACE::python::handle<>(pyResult)};
+            AR_BOOST_NAMESPACE::python::extract<Result> extractor(resultObject);
+            if (!extractor.check()) {
+                return false;
+            }
+            *result = extractor();
+        } catch (const AR_BOOST_NAMESPACE::python::error_already_set&) {
+            _HandleError();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static void _HandleError()
+    {
+        PXR_NS::TfPyConvertPythonExceptionToTfErrors();
+        PyErr_Clear();
+    }
+
+    bool _IsBound() const
+    {
+        if (!_callable) {
+            return false;
+        }
+        PyObject* module = PyDict_GetItem(PyImport_GetModuleDict(), _moduleNameObject);
+        if (module != _module) {
+            return false;
+        }
+        if (!PyModule_Check(module)) {
+            return true;
+        }
+        return PyDict_GetItem(PyModule_GetDict(module), _topLevelNameObject) == _topLevelObject;
+    }
+
+    bool _Bind() const
+    {
+        if (_attributeNames.empty()) {
+            return false;
+        }
+        if (!_moduleNameObject) {
+            _moduleNameObject = PyUnicode_InternFromString(_moduleName.c_str());
+            _topLevelNameObject = PyUnicode_InternFromString(_attributeNames.front().c_str());
+            if (!_moduleNameObject || !_topLevelNameObject) {
+                Py_CLEAR(_moduleNameObject);
+                Py_CLEAR(_topLevelNameObject);
+                _HandleError();
+                return false;
+            }
+        }
+        PyObject* module = PyImport_Import(_moduleNameObject);
+        if (!module) {
+            _HandleError();
+            return false;
+        }
+        PyObject* topLevelObject = nullptr;
+        PyObject* object = module;
+        Py_INCREF(object);
+        for (const std::string& attributeName : _attributeNames) {
+            PyObject* attribute = PyObject_GetAttrString(object, attributeName.c_str());
+            Py_DECREF(object);
+            if (!attribute) {
+                Py_XDECREF(topLevelObject);
+                Py_DECREF(module);
+                _HandleError();
+                return false;
+            }
+            if (!topLevelObject) {
+                topLevelObject = attribute;
+                Py_INCREF(topLevelObject);
+            }
+            object = attribute;
+        }
+        Py_XDECREF(_module);
+        Py_XDECREF(_topLevelObject);
+        Py_XDECREF(_callable);
+        // PyImport_Import returns the sys.modules entry, so this is what _IsBound compares against.
+        _module = module;
+        _topLevelObject = topLevelObject;
+        _callable = object;
+        return true;
+    }
+
+    template <typename... Args>
+    PyObject* _Call(const Args&... args) const
+    {
+        if (!this->_IsBound() && !this->_Bind()) {
+            return nullptr;
+        }
+        constexpr Py_ssize_t argCount = sizeof...(Args);
+        const bool isReused = _argTuple && !_isArgTupleInUse;
+        PyObject* argTuple = isReused ? _argTuple : PyTuple_New(argCount);
+        if (!argTuple) {
+            _HandleError();
+            return nullptr;
+        }
+        try {
+            Py_ssize_t argIdx = 0;
+            // This is the same conversion TfPyInvoke does.
+            ((PyTuple_SET_ITEM(argTuple, argIdx++, AR_BOOST_NAMESPACE::python::incref(PXR_NS::TfPyObject(args).ptr()))), ...);
+        } catch (const AR_BOOST_NAMESPACE::python::error_already_set&) {
+            _ReleaseArgTuple(argTuple, isReused);
+            _HandleError();
+            return nullptr;
+        }
+        _isArgTupleInUse = _isArgTupleInUse || isReused;
+        PyObject* pyResult = PyObject_Call(_callable, argTuple, nullptr);
+        if (isReused) {
+            _isArgTupleInUse = false;
+        }
+        _ReleaseArgTuple(argTuple, isReused);
+        if (!pyResult) {
+            _HandleError();
+        }
+        return pyResult;
+    }
+
+    void _ReleaseArgTuple(PyObject* argTuple, bool isReused) const
+    {
+        // If the callee kept a reference, the tuple can't be refilled.
+        if (Py_REFCNT(argTuple) != 1 || (!isReused && _argTuple)) {
+            Py_DECREF(argTuple);
+            if (isReused) {
+                _argTuple = nullptr;
+            }
+            return;
+        }
+        for (Py_ssize_t argIdx = 0; argIdx < PyTuple_GET_SIZE(argTuple); argIdx++) {
+            PyObject* arg = PyTuple_GET_ITEM(argTuple, argIdx);
+            PyTuple_SET_ITEM(argTuple, argIdx, nullptr);
+            Py_XDECREF(arg);
+        }
+        _argTuple = argTuple;
+    }
+
+    const std::string _moduleName;
+    const std::string _functionPath;
+    const std::vector<std::string> _attributeNames;
+    mutable PyObject* _moduleNameObject{nullptr};
+    mutable PyObject* _topLevelNameObject{nullptr};
+    mutable PyObject* _module{nullptr};
+    mutable PyObject* _topLevelObject{nullptr};
+    mutable PyObject* _callable{nullptr};
+    mutable PyObject* _argTuple{nullptr};
+    mutable bool _isArgTupleInUse{false};
+};
+
+#endif // PYTHON_HOOK_H
@@ -0,0 +1,255 @@
+#ifndef READ_AHEAD_POOL_H
+#define READ_AHEAD_POOL_H
+
+#include "concurrent_string_map.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Read Ahead Pool
+An opt-in background pool, that hints the OS to load resolved files into the page cache,
+so that the first read (via _OpenAsset) of files on network storage doesn't stall composition.
+Files get hinted via posix_fadvise(WILLNEED) on Linux and F_RDADVISE on macOS,
+on other platforms the pool stays disabled.
+
+- Only paths that weren't seen before (or whose prefetch expired) get queued, so repeated
+  resolves of the same path are cheap.
+- The number of queued and running prefetches is bounded by maxInFlight, once the limit
+  is reached new prefetches are dropped instead of blocking the resolver.
+- Open accounting: opens of prefetched files count as hits if the prefetch already finished,
+  as late if it is still queued/running and as misses if the file wasn't prefetched.
+- Finished prefetches expire after the configured expiration, as the OS can evict the pages
+  in the meantime. Expired paths get prefetched again on their next resolve.
+- At most _maxStateCount paths are tracked, once the limit is reached the expired (or if that
+  isn't enough, all finished) paths are dropped, so the memory stays bounded.
+*/
+class ReadAheadPool
+{
+public:
+    static ReadAheadPool& GetInstance()
+    {
+        // This is intentionally leaked, as the (detached) workers can outlive static destruction.
+        static ReadAheadPool* instance = new ReadAheadPool();
+        return *instance;
+    }
+
+    ReadAheadPool(const ReadAheadPool&) = delete;
+    ReadAheadPool& operator=(const ReadAheadPool&) = delete;
+
+    using Clock = std::chrono::steady_clock;
+
+    // A threadCount of 0 disables the pool, workers are only ever added, never removed.
+    // An expiration (in seconds) of 0 keeps finished prefetches until they get dropped due to the state limit.
+    void Configure(size_t threadCount, size_t maxInFlight, double expiration)
+    {
+#if defined(__linux__) || defined(__APPLE__)
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxInFlight = maxInFlight;
+        _expiration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(expiration, 0.0))).count();
+        while (_threadCount < threadCount) {
+            std::thread(&ReadAheadPool::_Work, this).detach();
+            ++_threadCount;
+        }
+        _isEnabled = _threadCount != 0 && _maxInFlight != 0;
+#endif
+    }
+
+    bool IsEnabled() const { return _isEnabled; }
+
+    void Prefetch(const std::string& filePath)
+    {
+        if (!_isEnabled || filePath.empty()) {
+            return;
+        }
+        const Clock::time_point now = Clock::now();
+        _Entry entry;
+        const bool isSeen = _states.Find(filePath, &entry);
+        if (isSeen && !this->_IsExpired(entry, now)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_inFlightCount >= _maxInFlight) {
+                ++_droppedCount;
+                return;
+            }
+            const _Entry queuedEntry{_State::Queued, now};
+            if (isSeen) {
+                // If another thread re-queued the expired path in the meantime, we are done.
+                if (!_states.CompareAndAssign(filePath, entry, queuedEntry)) {
+                    return;
+                }
+            } else {
+                if (_stateCount >= _maxStateCount) {
+                    this->_ExpireStates(now);
+                }
+                if (!_states.Insert(filePath, queuedEntry)) {
+                    return;
+                }
+                ++_stateCount;
+            }
+            _queue.push_back(filePath);
+            ++_inFlightCount;
+        }
+        ++_prefetchCount;
+        _condition.notify_one();
+    }
+
+    void NotifyOpen(const std::string& filePath)
+    {
+        if (!_isEnabled) {
+            return;
+        }
+        _Entry entry;
+        if (!_states.Find(filePath, &entry)) {
+            ++_missCount;
+        } else if (entry.state == _State::Done) {
+            // Only the first open of a prefetched file gets counted.
+            if (_states.CompareAndAssign(filePath, entry, _Entry{_State::Opened, entry.time})) {
+                ++_hitCount;
+            }
+        } else if (entry.state != _State::Opened) {
+            ++_lateCount;
+        }
+    }
+
+    std::map<std::string, double> GetStatistics() const
+    {
+        return {
+            {"prefetchCount", static_cast<double>(_prefetchCount.load())},
+            {"droppedCount", static_cast<double>(_droppedCount.load())},
+            {"hitCount", static_cast<double>(_hitCount.load())},
+            {"lateCount", static_cast<double>(_lateCount.load())},
+            {"missCount", static_cast<double>(_missCount.load())}
+        };
+    }
+
+    void ResetStatistics()
+    {
+        _prefetchCount = 0;
+        _droppedCount = 0;
+        _hitCount = 0;
+        _lateCount = 0;
+        _missCount = 0;
+    }
+
+    // Forgets all seen paths, so that they get prefetched again on their next resolve.
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const size_t erasedCount = _states.EraseIf([](const std::string&, const _Entry& entry){ return entry.state != _State::Queued; });
+        _stateCount -= std::min(erasedCount, _stateCount);
+    }
+
+private:
+    enum class _State
+    {
+        Queued,
+        Done,
+        Opened
+    };
+
+    // The time is when the prefetch got queued (Queued) or finished (Done/Opened).
+    struct _Entry
+    {
+        _State state;
+        Clock::time_point time;
+
+        bool operator==(const _Entry& other) const { return state == other.state && time == other.time; }
+    };
+
+    static constexpr size_t _maxStateCount = 65536;
+
+    ReadAheadPool() = default;
+
+    bool _IsExpired(const _Entry& entry, Clock::time_point now) const
+    {
+        const Clock::rep expiration = _expiration.load(std::memory_order_relaxed);
+        return entry.state != _State::Queued && expiration != 0 && (now - entry.time).count() >= expiration;
+    }
+
+    // Has to be called with the lock held.
+    void _ExpireStates(Clock::time_point now)
+    {
+        size_t erasedCount = _states.EraseIf([this, now](const std::string&, const _Entry& entry){ return this->_IsExpired(entry, now); });
+        if (_stateCount - std::min(erasedCount, _stateCount) >= _maxStateCount) {
+            erasedCount += _states.EraseIf([](const std::string&, const _Entry& entry){ return entry.state != _State::Queued; });
+        }
+        _stateCount -= std::min(erasedCount, _stateCount);
+    }
+
+    static void _Advise(const std::string& filePath)
+    {
+#if defined(__linux__)
+        const int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+#elif defined(__APPLE__)
+        const int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            const off_t fileSize = lseek(fd, 0, SEEK_END);
+            if (fileSize > 0) {
+                radvisory advisory;
+                advisory.ra_offset = 0;
+                advisory.ra_count = fileSize > INT32_MAX ? INT32_MAX : static_cast<int>(fileSize);
+                fcntl(fd, F_RDADVISE, &advisory);
+            }
+            close(fd);
+        }
+#endif
+    }
+
+    void _Work()
+    {
+        while (true) {
+            std::string filePath;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this](){ return !_queue.empty(); });
+                filePath = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _Advise(filePath);
+            _Entry entry;
+            if (_states.Find(filePath, &entry) && entry.state == _State::Queued) {
+                _states.CompareAndAssign(filePath, entry, _Entry{_State::Done, Clock::now()});
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_inFlightCount;
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::string> _queue;
+    size_t _threadCount{0};
+    size_t _maxInFlight{0};
+    size_t _inFlightCount{0};
+    size_t _stateCount{0};
+    std::atomic<Clock::rep> _expiration{0};
+    std::atomic<bool> _isEnabled{false};
+    ConcurrentStringMap<_Entry> _states;
+    std::atomic<uint64_t> _prefetchCount{0};
+    std::atomic<uint64_t> _droppedCount{0};
+    std::atomic<uint64_t> _hitCount{0};
+    std::atomic<uint64_t> _lateCount{0};
+    std::atomic<uint64_t> _missCount{0};
+};
+
+#endif // READ_AHEAD_POOL_H
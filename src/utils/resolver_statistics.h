@@ -0,0 +1,164 @@
+#ifndef RESOLVER_STATISTICS_H
+#define RESOLVER_STATISTICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+enum class ResolverStatistic : size_t
+{
+    ResolveCount,
+    CreateIdentifierCount,
+    CacheHitCount,
+    CacheMissCount,
+    MappingHitCount,
+    PythonCallCount,
+    PythonTime,
+    NativeCallCount,
+    NativeTime,
+    LockWaitTime,
+    StatCallCount,
+    ContextCreationCount,
+    ScopedCacheHitCount,
+    Count
+};
+
+/* Resolver Statistics
+Process wide resolver counters/timers, that are cheap enough to stay enabled in production.
+Each thread increments its own (cache line separated) counters without any
+atomic read-modify-write or lock, the counters are only aggregated when they get read.
+The Tag template parameter separates the counters of the different resolver plugins,
+as they can be loaded into the same process.
+Timers are accumulated in nanoseconds and reported in seconds.
+*/
+template <typename Tag>
+class ResolverStatistics
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static void Add(ResolverStatistic statistic, uint64_t value = 1)
+    {
+        std::atomic<uint64_t>& counter = _GetThreadCounters().values[static_cast<size_t>(statistic)];
+        // Only the owning thread writes to its counters.
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static void AddTime(ResolverStatistic statistic, Clock::time_point startTime)
+    {
+        Add(statistic, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count());
+    }
+
+    static std::map<std::string, double> Get()
+    {
+        static const char* names[_count] = {
+            "resolveCount", "createIdentifierCount", "cacheHitCount", "cacheMissCount", "mappingHitCount",
+            "pythonCallCount", "pythonTime", "nativeCallCount", "nativeTime", "lockWaitTime", "statCallCount", "contextCreationCount",
+            "scopedCacheHitCount"
+        };
+        const std::array<uint64_t, _count> values = _Aggregate();
+        std::map<std::string, double> statistics;
+        for (size_t i = 0; i < _count; i++) {
+            const bool isTime = i == static_cast<size_t>(ResolverStatistic::PythonTime) ||
+                                i == static_cast<size_t>(ResolverStatistic::NativeTime) ||
+                                i == static_cast<size_t>(ResolverStatistic::LockWaitTime);
+            statistics[names[i]] = isTime ? static_cast<double>(values[i]) * 1e-9 : static_cast<double>(values[i]);
+        }
+        return statistics;
+    }
+
+    static void Reset()
+    {
+        // The counters are owned by their threads, so instead of zeroing
+        // them we store the current values as the new base line.
+        _Registry& registry = _GetRegistry();
+        const std::array<uint64_t, _count> values = _AggregateTotal();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.resetValues = values;
+    }
+
+private:
+    static constexpr size_t _count = static_cast<size_t>(ResolverStatistic::Count);
+
+    struct alignas(64) _Counters
+    {
+        std::array<std::atomic<uint64_t>, _count> values{};
+    };
+
+    struct _Registry
+    {
+        std::mutex mutex;
+        std::set<const _Counters*> threadCounters;
+        // The counters of exited threads.
+        std::array<uint64_t, _count> retiredValues{};
+        std::array<uint64_t, _count> resetValues{};
+    };
+
+    struct _ThreadCounters
+    {
+        _Counters counters;
+
+        _ThreadCounters()
+        {
+            _Registry& registry = _GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threadCounters.insert(&counters);
+        }
+
+        ~_ThreadCounters()
+        {
+            _Registry& registry = _GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (size_t i = 0; i < _count; i++) {
+                registry.retiredValues[i] += counters.values[i].load(std::memory_order_relaxed);
+            }
+            registry.threadCounters.erase(&counters);
+        }
+    };
+
+    static _Registry& _GetRegistry()
+    {
+        // This is intentionally leaked, as threads can exit after static destruction.
+        static _Registry* registry = new _Registry();
+        return *registry;
+    }
+
+    static _Counters& _GetThreadCounters()
+    {
+        thread_local _ThreadCounters threadCounters;
+        return threadCounters.counters;
+    }
+
+    static std::array<uint64_t, _count> _AggregateTotal()
+    {
+        _Registry& registry = _GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        std::array<uint64_t, _count> values = registry.retiredValues;
+        for (const _Counters* counters : registry.threadCounters) {
+            for (size_t i = 0; i < _count; i++) {
+                values[i] += counters->values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return values;
+    }
+
+    static std::array<uint64_t, _count> _Aggregate()
+    {
+        std::array<uint64_t, _count> values = _AggregateTotal();
+        _Registry& registry = _GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t i = 0; i < _count; i++) {
+            values[i] -= std::min(values[i], registry.resetValues[i]);
+        }
+        return values;
+    }
+};
+
+#endif // RESOLVER_STATISTICS_H
@@ -0,0 +1,69 @@
+#ifndef SCOPED_RESOLVE_CACHE_H
+#define SCOPED_RESOLVE_CACHE_H
+
+#include "concurrent_string_map.h"
+
+#include "pxr/pxr.h"
+#include "pxr/usd/ar/resolvedPath.h"
+#include "pxr/usd/ar/timestamp.h"
+
+#include <string>
+
+/* Scoped Resolve Cache
+Holds the _Resolve, _CreateIdentifier and _GetModificationTimestamp results of a single
+ArResolverScopedCache. Resolvers keep it in their ArThreadLocalScopedCache, which hands the
+same instance to all threads the scope data gets passed to (e.g. Usd's parallel composition),
+so the results are stored in concurrent maps.
+As with Ar's default resolver, results are only keyed by their inputs, context edits
+and file system changes are picked up once the scope ends.
+*/
+class ScopedResolveCache
+{
+public:
+    bool FindResolvedPath(const std::string& assetPath, PXR_NS::ArResolvedPath* resolvedPath) const
+    {
+        return _resolvedPaths.Find(assetPath, resolvedPath);
+    }
+
+    void AddResolvedPath(const std::string& assetPath, const PXR_NS::ArResolvedPath& resolvedPath)
+    {
+        _resolvedPaths.Insert(assetPath, resolvedPath);
+    }
+
+    bool FindIdentifier(const std::string& assetPath, const PXR_NS::ArResolvedPath& anchorAssetPath, std::string* identifier) const
+    {
+        return _identifiers.Find(_GetIdentifierKey(assetPath, anchorAssetPath), identifier);
+    }
+
+    void AddIdentifier(const std::string& assetPath, const PXR_NS::ArResolvedPath& anchorAssetPath, const std::string& identifier)
+    {
+        _identifiers.Insert(_GetIdentifierKey(assetPath, anchorAssetPath), identifier);
+    }
+
+    bool FindModificationTimestamp(const PXR_NS::ArResolvedPath& resolvedPath, PXR_NS::ArTimestamp* timestamp) const
+    {
+        return _modificationTimestamps.Find(resolvedPath.GetPathString(), timestamp);
+    }
+
+    void AddModificationTimestamp(const PXR_NS::ArResolvedPath& resolvedPath, const PXR_NS::ArTimestamp& timestamp)
+    {
+        _modificationTimestamps.Insert(resolvedPath.GetPathString(), timestamp);
+    }
+
+private:
+    static std::string _GetIdentifierKey(const std::string& assetPath, const PXR_NS::ArResolvedPath& anchorAssetPath)
+    {
+        // Null characters can't be part of a path, so the key is unambiguous.
+        std::string key = anchorAssetPath.GetPathString();
+        key += '\0';
+        key += assetPath;
+        return key;
+    }
+
+    // Scopes are short lived, so we trade some lock contention for cheaper construction.
+    ConcurrentStringMap<PXR_NS::ArResolvedPath, 16> _resolvedPaths;
+    ConcurrentStringMap<std::string, 16> _identifiers;
+    ConcurrentStringMap<PXR_NS::ArTimestamp, 16> _modificationTimestamps;
+};
+
+#endif // SCOPED_RESOLVE_CACHE_H
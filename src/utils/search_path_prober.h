@@ -0,0 +1,331 @@
+#ifndef SEARCH_PATH_PROBER_H
+#define SEARCH_PATH_PROBER_H
+
+#include "concurrent_string_map.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Search Path Prober
+An opt-in pool, that checks the search paths of a resolve concurrently instead of one after
+another, so that a slow mount only adds its latency once instead of to every lookup behind it.
+
+- Search path priority is kept: the first search path (in search path order) that has the file wins,
+  a result is only returned once all higher priority search paths have answered.
+- Queued probes of lower priority search paths are skipped once a higher priority one found the file.
+  Probes that are already running (e.g. a stat on a hanging mount) can't be interrupted, they finish
+  in the background.
+- Search paths that don't answer within the timeout (in seconds) are treated as misses for that
+  resolve and are quarantined (skipped) for the quarantine duration (in seconds). After that
+  they get probed again. A timeout of 0 waits for all probes.
+- Results that were affected by a timeout or quarantine (a higher priority search path didn't answer)
+  are flagged as degraded, so that callers don't memoize them.
+- Latency statistics are kept per search path (probe/hit/timeout counts, mean/max latency).
+- For testing, a probe delay can be set per search path to simulate slow mounts.
+Search path statistics are kept until Clear is called, so the memory grows with the number of search paths.
+*/
+class SearchPathProber
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using ProbeFn = std::function<bool(const std::string& searchPath)>;
+
+    static SearchPathProber& GetInstance()
+    {
+        // This is intentionally leaked, as the (detached) workers can outlive static destruction.
+        static SearchPathProber* instance = new SearchPathProber();
+        return *instance;
+    }
+
+    SearchPathProber(const SearchPathProber&) = delete;
+    SearchPathProber& operator=(const SearchPathProber&) = delete;
+
+    // A threadCount of 0 disables the pool, workers are only ever added, never removed.
+    void Configure(size_t threadCount, double timeout, double quarantineDuration)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _timeout = _ToClockRep(timeout);
+        _quarantineDuration = _ToClockRep(quarantineDuration);
+        while (_threadCount < threadCount) {
+            std::thread(&SearchPathProber::_Work, this).detach();
+            ++_threadCount;
+        }
+        _isEnabled = threadCount != 0 && _threadCount != 0;
+    }
+
+    bool IsEnabled() const { return _isEnabled; }
+
+    /* Returns the index of the first search path the probe function returned true for,
+    or -1 if none did (or if all remaining search paths timed out). isDegraded is set if
+    a higher priority search path was skipped due to a timeout or quarantine. The probe
+    function is called from the worker threads and can outlive this call, so it must not
+    reference any state of the caller.
+    */
+    int Probe(const std::vector<std::string>& searchPaths, const ProbeFn& probeFn, bool* isDegraded = nullptr)
+    {
+        std::shared_ptr<_Probe> probe = std::make_shared<_Probe>();
+        probe->probeFn = probeFn;
+        probe->states.resize(searchPaths.size(), _ProbeState::Pending);
+        const Clock::rep now = Clock::now().time_since_epoch().count();
+        std::vector<std::shared_ptr<_Task>> tasks;
+        tasks.reserve(searchPaths.size());
+        for (size_t i = 0; i < searchPaths.size(); i++) {
+            std::shared_ptr<_SearchPath> searchPath = this->_GetSearchPath(searchPaths[i]);
+            if (searchPath->quarantinedUntil.load() > now) {
+                ++searchPath->quarantineSkipCount;
+                probe->states[i] = _ProbeState::Skipped;
+                continue;
+            }
+            tasks.push_back(std::make_shared<_Task>(_Task{probe, searchPath, searchPaths[i], i}));
+        }
+        ++_probeCount;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _queue.insert(_queue.end(), tasks.begin(), tasks.end());
+        }
+        _condition.notify_all();
+
+        const Clock::rep timeout = _timeout.load();
+        const Clock::time_point deadline = Clock::now() + Clock::duration(timeout);
+        std::unique_lock<std::mutex> probeLock(probe->mutex);
+        int result = -1;
+        while (!_GetResult(*probe, &result)) {
+            if (timeout == 0) {
+                probe->condition.wait(probeLock);
+            } else if (probe->condition.wait_until(probeLock, deadline) == std::cv_status::timeout) {
+                this->_TimeoutPending(*probe, tasks);
+                _GetResult(*probe, &result);
+                break;
+            }
+        }
+        // Probes that are still queued don't need to run anymore.
+        probe->isDone = true;
+        if (isDegraded) {
+            // Only timeouts/quarantines skip search paths before the first hit.
+            const size_t resultIndex = result < 0 ? probe->states.size() : static_cast<size_t>(result);
+            *isDegraded = std::find(probe->states.begin(), probe->states.begin() + resultIndex, _ProbeState::Skipped) !=
+                          probe->states.begin() + resultIndex;
+        }
+        return result;
+    }
+
+    // Delays all probes of the search path, this is only meant for testing slow mounts.
+    void SetProbeDelay(const std::string& searchPath, double delay)
+    {
+        this->_GetSearchPath(searchPath)->probeDelay = _ToClockRep(delay);
+    }
+
+    std::map<std::string, double> GetStatistics() const
+    {
+        return {
+            {"probeCount", static_cast<double>(_probeCount.load())},
+            {"cancelledCount", static_cast<double>(_cancelledCount.load())},
+            {"timeoutCount", static_cast<double>(_timeoutCount.load())}
+        };
+    }
+
+    std::map<std::string, std::map<std::string, double>> GetSearchPathStatistics() const
+    {
+        std::map<std::string, std::map<std::string, double>> statistics;
+        const Clock::rep now = Clock::now().time_since_epoch().count();
+        _searchPaths.ForEach([&statistics, now](const std::string& path, const std::shared_ptr<_SearchPath>& searchPath){
+            const uint64_t probeCount = searchPath->probeCount.load();
+            const double latency = std::chrono::duration<double>(Clock::duration(searchPath->latencySum.load())).count();
+            statistics[path] = {
+                {"probeCount", static_cast<double>(probeCount)},
+                {"hitCount", static_cast<double>(searchPath->hitCount.load())},
+                {"timeoutCount", static_cast<double>(searchPath->timeoutCount.load())},
+                {"quarantineSkipCount", static_cast<double>(searchPath->quarantineSkipCount.load())},
+                {"meanLatency", probeCount ? latency / probeCount : 0.0},
+                {"maxLatency", std::chrono::duration<double>(Clock::duration(searchPath->latencyMax.load())).count()},
+                {"isQuarantined", searchPath->quarantinedUntil.load() > now ? 1.0 : 0.0}
+            };
+        });
+        return statistics;
+    }
+
+    // Resets all statistics and lifts all quarantines.
+    void Clear()
+    {
+        _searchPaths.Clear();
+        _probeCount = 0;
+        _cancelledCount = 0;
+        _timeoutCount = 0;
+    }
+
+private:
+    enum class _ProbeState
+    {
+        Pending,
+        Running,
+        Hit,
+        Miss,
+        Skipped
+    };
+
+    struct _SearchPath
+    {
+        std::atomic<uint64_t> probeCount{0};
+        std::atomic<uint64_t> hitCount{0};
+        std::atomic<uint64_t> timeoutCount{0};
+        std::atomic<uint64_t> quarantineSkipCount{0};
+        std::atomic<Clock::rep> latencySum{0};
+        std::atomic<Clock::rep> latencyMax{0};
+        std::atomic<Clock::rep> quarantinedUntil{0};
+        std::atomic<Clock::rep> probeDelay{0};
+    };
+
+    struct _Probe
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        ProbeFn probeFn;
+        std::vector<_ProbeState> states;
+        std::atomic<bool> isDone{false};
+    };
+
+    struct _Task
+    {
+        std::shared_ptr<_Probe> probe;
+        std::shared_ptr<_SearchPath> searchPath;
+        std::string path;
+        size_t index;
+    };
+
+    SearchPathProber() = default;
+
+    static Clock::rep _ToClockRep(double seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.0))).count();
+    }
+
+    // The result is final once a search path has the file and all higher priority ones answered.
+    static bool _GetResult(const _Probe& probe, int* result)
+    {
+        for (size_t i = 0; i < probe.states.size(); i++) {
+            if (probe.states[i] == _ProbeState::Pending || probe.states[i] == _ProbeState::Running) {
+                return false;
+            }
+            if (probe.states[i] == _ProbeState::Hit) {
+                *result = static_cast<int>(i);
+                return true;
+            }
+        }
+        *result = -1;
+        return true;
+    }
+
+    // A hit at a higher priority search path makes the probe redundant.
+    static bool _IsCancelled(const _Probe& probe, size_t index)
+    {
+        if (probe.isDone) {
+            return true;
+        }
+        for (size_t i = 0; i < index; i++) {
+            if (probe.states[i] == _ProbeState::Hit) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void _TimeoutPending(_Probe& probe, const std::vector<std::shared_ptr<_Task>>& tasks)
+    {
+        const Clock::rep quarantinedUntil = Clock::now().time_since_epoch().count() + _quarantineDuration.load();
+        for (const std::shared_ptr<_Task>& task : tasks) {
+            const _ProbeState state = probe.states[task->index];
+            if (state != _ProbeState::Pending && state != _ProbeState::Running) {
+                continue;
+            }
+            probe.states[task->index] = _ProbeState::Skipped;
+            // Probes that are still queued (e.g. behind a hanging mount) don't say anything about their search path.
+            if (state == _ProbeState::Pending) {
+                continue;
+            }
+            ++task->searchPath->timeoutCount;
+            task->searchPath->quarantinedUntil = quarantinedUntil;
+            ++_timeoutCount;
+        }
+    }
+
+    std::shared_ptr<_SearchPath> _GetSearchPath(const std::string& path)
+    {
+        return _searchPaths.FindOrInsert(path, [](){ return std::make_shared<_SearchPath>(); });
+    }
+
+    void _Run(const _Task& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(task.probe->mutex);
+            if (_IsCancelled(*task.probe, task.index)) {
+                if (task.probe->states[task.index] == _ProbeState::Pending) {
+                    task.probe->states[task.index] = _ProbeState::Skipped;
+                }
+                ++_cancelledCount;
+                task.probe->condition.notify_all();
+                return;
+            }
+            task.probe->states[task.index] = _ProbeState::Running;
+        }
+        const Clock::time_point startTime = Clock::now();
+        if (const Clock::rep probeDelay = task.searchPath->probeDelay.load()) {
+            std::this_thread::sleep_for(Clock::duration(probeDelay));
+        }
+        const bool exists = task.probe->probeFn(task.path);
+        const Clock::rep latency = (Clock::now() - startTime).count();
+        _SearchPath& searchPath = *task.searchPath;
+        ++searchPath.probeCount;
+        searchPath.latencySum += latency;
+        Clock::rep latencyMax = searchPath.latencyMax.load();
+        while (latency > latencyMax && !searchPath.latencyMax.compare_exchange_weak(latencyMax, latency)) {}
+        if (exists) {
+            ++searchPath.hitCount;
+        }
+        std::lock_guard<std::mutex> lock(task.probe->mutex);
+        // Timed out probes keep their (skipped) state, late answers are only accounted.
+        if (task.probe->states[task.index] == _ProbeState::Running) {
+            task.probe->states[task.index] = exists ? _ProbeState::Hit : _ProbeState::Miss;
+        }
+        task.probe->condition.notify_all();
+    }
+
+    void _Work()
+    {
+        while (true) {
+            std::shared_ptr<_Task> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this](){ return !_queue.empty(); });
+                task = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            this->_Run(*task);
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::shared_ptr<_Task>> _queue;
+    size_t _threadCount{0};
+    std::atomic<bool> _isEnabled{false};
+    std::atomic<Clock::rep> _timeout{0};
+    std::atomic<Clock::rep> _quarantineDuration{0};
+    ConcurrentStringMap<std::shared_ptr<_SearchPath>> _searchPaths;
+    std::atomic<uint64_t> _probeCount{0};
+    std::atomic<uint64_t> _cancelledCount{0};
+    std::atomic<uint64_t> _timeoutCount{0};
+};
+
+#endif // SEARCH_PATH_PROBER_H